@@ -16,7 +16,7 @@
  *
  * @return Nenhum.
  */
-static void build_perm_string(struct ext2_inode *inode, char out[11])
+void build_perm_string(struct ext2_inode *inode, char out[11])
 {
     uint16_t mode = inode->i_mode;
 
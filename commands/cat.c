@@ -4,130 +4,46 @@
 
 #include "commands.h"
 
-/** * @brief   Lê um bloco do sistema de arquivos EXT2 e escreve seu conteúdo no stdout.
- *
- * Se o número do bloco for zero, escreve zeros. Caso contrário,
- * lê o bloco do sistema de arquivos e escreve seu conteúdo.
- *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param blk   Número do bloco a ser lido (0 para bloco vazio).
- * @param nbytes Número de bytes a serem escritos.
- *
- * @return Retorna 0 em caso de sucesso, ou 1 em caso de erro.
- */
-int dump_blk(ext2_fs_t *fs, uint32_t blk, uint32_t nbytes)
-{
-    static uint8_t zbuf[EXT2_BLOCK_SIZE] = {0}; // Buffer de zeros para blocos vazios
-    uint8_t buf[EXT2_BLOCK_SIZE];               // Buffer para leitura do bloco
-
-    const void *src = zbuf;
-    if (blk)
-    {
-        if (fs_read_block(fs, blk, buf) < 0) // Lê o bloco do sistema de arquivos
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
-        src = buf;
-    }
-    size_t written = fwrite(src, 1, nbytes, stdout); // Escreve o conteúdo
-    if (written != nbytes)
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    return EXIT_SUCCESS;
-}
-
 /**
- * @brief   Lê o conteúdo de um arquivo regular do sistema de arquivos EXT2 e o escreve no stdout.
- *
- * Lê os blocos do inode do arquivo e escreve seu conteúdo no stdout.
- * Suporta blocos diretos, indiretos simples e indiretos duplos.
+ * @brief   Escreve no stdout um trecho de um arquivo, em lotes de até FS_READ_BATCH_BYTES.
  *
  * @param fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param in   Ponteiro para o inode do arquivo a ser lido.
+ * @param ino  Número do inode do arquivo.
+ * @param off  Deslocamento do trecho no arquivo.
+ * @param len  Tamanho do trecho (limitado ao fim do arquivo).
  *
- * @return Retorna 0 em caso de sucesso, ou 1 em caso de erro.
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro.
  */
-int dump_file(ext2_fs_t *fs, const struct ext2_inode *in)
+static int cat_range(ext2_fs_t *fs, uint32_t ino, off_t off, unsigned long long len)
 {
-    uint32_t bytes_left = in->i_size;
+    uint8_t *buf = malloc(FS_READ_BATCH_BYTES);
+    if (!buf)
+        return -1;
 
-    // Blocos diretos
-    for (int i = 0; i < 12 && bytes_left > 0; ++i)
+    int ret = 0;
+    while (len)
     {
-        uint32_t to_read = (bytes_left < EXT2_BLOCK_SIZE) ? bytes_left : EXT2_BLOCK_SIZE; // Tamanho a ser lido
-        if (dump_blk(fs, in->i_block[i], to_read))
+        size_t want = len < FS_READ_BATCH_BYTES ? (size_t)len : FS_READ_BATCH_BYTES;
+        ssize_t n = fs_read_file(fs, ino, buf, want, off);
+        if (n < 0 || fwrite(buf, 1, (size_t)n, stdout) != (size_t)n)
         {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        } // Lê o bloco do sistema de arquivos
-        bytes_left -= to_read;
-    }
-
-    // Bloco indireto simples
-    if (bytes_left > 0 && in->i_block[12])
-    {
-        uint8_t buf[EXT2_BLOCK_SIZE];                    // Buffer para leitura do bloco indireto
-        if (fs_read_block(fs, in->i_block[12], buf) < 0) // Lê o bloco indireto simples
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
-        uint32_t *indirect = (uint32_t *)buf;
-        for (uint32_t i = 0; i < PTRS_PER_BLOCK && bytes_left > 0; ++i) // Lê os blocos indiretos
-        {
-            uint32_t to_read = (bytes_left > EXT2_BLOCK_SIZE) ? EXT2_BLOCK_SIZE : bytes_left; // Tamanho a ser lido
-
-            if (dump_blk(fs, indirect[i], to_read)) // Lê o bloco indireto
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-            bytes_left -= to_read;
+            ret = -1;
+            break;
         }
+        if (n == 0) // Fim do arquivo
+            break;
+        off += n;
+        len -= (unsigned long long)n;
     }
-
-    // Bloco indireto duplo
-    if (bytes_left > 0 && in->i_block[13])
-    {
-        uint8_t buf1[EXT2_BLOCK_SIZE], buf2[EXT2_BLOCK_SIZE]; // Buffers para leitura
-        if (fs_read_block(fs, in->i_block[13], buf1) < 0)
-            return EXIT_FAILURE;
-        uint32_t *dbl_indirect = (uint32_t *)buf1;
-
-        for (uint32_t i = 0; i < PTRS_PER_BLOCK && bytes_left > 0; ++i) // Lê os blocos indiretos duplos
-        {
-            if (!dbl_indirect[i]) // Verifica se o ponteiro é nulo
-                continue;
-            if (fs_read_block(fs, dbl_indirect[i], buf2) < 0) // Lê o bloco indireto duplo
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-            uint32_t *indirect = (uint32_t *)buf2;
-            for (uint32_t j = 0; j < PTRS_PER_BLOCK && bytes_left > 0; ++j) // Lê os blocos indiretos simples dentro do indireto duplo
-            {
-                uint32_t to_read = (bytes_left > EXT2_BLOCK_SIZE) ? EXT2_BLOCK_SIZE : bytes_left; // Tamanho a ser lido
-                // Lê o bloco indireto simples
-                if (dump_blk(fs, indirect[j], to_read) < 0)
-                {
-                    print_error(ERROR_UNKNOWN);
-                    return EXIT_FAILURE;
-                }
-                bytes_left -= to_read; // Atualiza o número de bytes restantes
-            }
-        }
-    }
-
-    return EXIT_SUCCESS;
+    free(buf);
+    return ret;
 }
 
 /**
  * @brief   Comando 'cat' para exibir o conteúdo de um arquivo regular no sistema de arquivos EXT2.
  *
  * Este comando recebe o nome de um arquivo e exibe seu conteúdo no stdout.
+ * Com <offset> e <length>, exibe apenas esse trecho do arquivo (lido com fs_read_file).
  * Se o arquivo não for encontrado ou não for um arquivo regular, exibe uma mensagem de erro.
  *
  * @param argc Número de argumentos passados para o comando.
@@ -139,7 +55,7 @@ int dump_file(ext2_fs_t *fs, const struct ext2_inode *in)
  */
 int cmd_cat(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
 {
-    if (argc != 2)
+    if (argc != 2 && argc != 4) // cat <file> [<offset> <length>]
     {
         print_error(ERROR_INVALID_SYNTAX);
         return EXIT_FAILURE;
@@ -175,7 +91,23 @@ int cmd_cat(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    if (dump_file(fs, &in)) // Lê o conteúdo do arquivo e escreve no stdout
+    if (argc == 4) // Exibe apenas um trecho do arquivo
+    {
+        char *end1, *end2;
+        unsigned long long off = strtoull(argv[2], &end1, 0);
+        unsigned long long len = strtoull(argv[3], &end2, 0);
+        if (*end1 || *end2 || argv[2][0] == '-' || argv[3][0] == '-')
+        {
+            print_error(ERROR_INVALID_SYNTAX);
+            return EXIT_FAILURE;
+        }
+        if (cat_range(fs, ino, (off_t)off, len) < 0)
+        {
+            print_error(ERROR_UNKNOWN);
+            return EXIT_FAILURE;
+        }
+    }
+    else if (fs_dump_file(fs, ino, stdout) < 0) // Lê o conteúdo do arquivo e escreve no stdout
     {
         print_error(ERROR_UNKNOWN);
         return EXIT_FAILURE;
@@ -19,8 +19,8 @@
  */
 static int find_entry_by_ino(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t tgt_ino, struct ext2_dir_entry *out)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE]; // Buffer para leitura dos blocos do diretório
-    for (int i = 0; i < 12; ++i)  // Percorre os blocos diretos do diretório
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE]; // Buffer para leitura dos blocos do diretório
+    for (int i = 0; i < 12; ++i)      // Percorre os blocos diretos do diretório
     {
         uint32_t bloco = dir_inode->i_block[i]; // Obtém o número do bloco
         if (!bloco)                             // Se o bloco não estiver alocado, pula para o próximo
@@ -32,8 +32,8 @@ static int find_entry_by_ino(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32
             return EXIT_FAILURE;
         }
 
-        uint32_t offset = 0;             // Inicializa o deslocamento para percorrer o bloco
-        while (offset < EXT2_BLOCK_SIZE) // Percorre o bloco até o final
+        uint32_t offset = 0;            // Inicializa o deslocamento para percorrer o bloco
+        while (offset < fs->block_size) // Percorre o bloco até o final
         {
             struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(buf + offset); // Obtém a entrada de diretório a partir do buffer
 
@@ -160,8 +160,9 @@ int cmd_cd(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         }
     }
 
-    free(parent_path); // Libera a memória alocada para o caminho do diretório pai
-    *cwd = dir_ino;    // Atualiza o diretório corrente
-    free(abs_path);    // Libera a memória alocada para o caminho absoluto
+    free(parent_path);                 // Libera a memória alocada para o caminho do diretório pai
+    *cwd = dir_ino;                    // Atualiza o diretório corrente
+    fs_set_cwd(fs, dir_ino, abs_path); // Atualiza o caminho do diretório corrente sem percorrer a árvore
+    free(abs_path);                    // Libera a memória alocada para o caminho absoluto
     return EXIT_SUCCESS;
 }
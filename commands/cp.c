@@ -4,37 +4,6 @@
 
 #include "commands.h"
 
-/**
- * @brief   Copia um arquivo do sistema de arquivos EXT2 para o sistema real.
- *
- * Esta função copia o conteúdo de um arquivo especificado pelo inode do EXT2
- * para um arquivo no sistema real, preservando a estrutura de blocos do EXT2.
- *
- * @param fs Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param ino Número do inode do arquivo a ser copiado.
- * @param dst Caminho completo do destino onde o arquivo será salvo.
- *
- * @return Retorna 0 em caso de sucesso, ou 1 em caso de erro.
- */
-int dump_block(ext2_fs_t *fs, uint32_t blk, FILE *fd, uint32_t bytes)
-{
-    static unsigned char zero_block[EXT2_BLOCK_SIZE] = {0}; // Bloco de zeros para blocos não alocados
-    unsigned char data_block[EXT2_BLOCK_SIZE];              // Buffer para armazenar os dados do bloco lido
-    const void *data = zero_block;                          // Inicializa com bloco de zeros
-
-    if (blk != 0) // Se o bloco não for zero (não alocado)
-    {
-        if (fs_read_block(fs, blk, data_block) < 0) // Lê o bloco do sistema de arquivos
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
-        data = data_block; // Usa o bloco lido como dados
-    }
-    size_t written = fwrite(data, 1, bytes, fd);             // Escreve os dados no arquivo de destino
-    return (written == bytes) ? EXIT_SUCCESS : EXIT_FAILURE; // Retorna 0 se a escrita foi bem-sucedida, 1 se houve erro
-}
-
 /**
  * @brief   Copia um arquivo do sistema de arquivos EXT2 para o sistema real.
  *
@@ -68,96 +37,11 @@ int copy_ext2_to_host(ext2_fs_t *fs, uint32_t ino, const char *dst)
         print_error(ERROR_DEST_DIR_NOT_EXISTS);
         return EXIT_FAILURE;
     }
-    uint32_t bytes_left = in.i_size; // Tamanho do arquivo a ser copiado
-    int result = 0;                  // Variável para armazenar o resultado da cópia
-
-    for (int i = 0; i < 12 && bytes_left; ++i) // Blocos diretos (0-11)
+    int result = 0;                    // Variável para armazenar o resultado da cópia
+    if (fs_dump_file(fs, ino, fd) < 0) // Sequências contíguas longas são copiadas pelo kernel; o resto, em lotes
     {
-        uint32_t n = (bytes_left >= EXT2_BLOCK_SIZE) ? EXT2_BLOCK_SIZE : bytes_left; // Tamanho do bloco a ser copiado
-        if (dump_block(fs, in.i_block[i], fd, n))                                    // Copia o bloco para o arquivo de destino
-        {
-            print_error(ERROR_UNKNOWN);
-            result = EXIT_FAILURE;
-            break;
-        }
-        bytes_left -= n;
-    }
-
-    if (result == 0 && bytes_left) // Bloco indireto simples (12)
-    {
-        unsigned char buf[EXT2_BLOCK_SIZE] = {0}; // Buffer para armazenar os blocos indiretos
-        if (in.i_block[12])                       // Verifica se o bloco indireto simples está alocado
-        {
-            if (fs_read_block(fs, in.i_block[12], buf) < 0)
-            {
-                print_error(ERROR_UNKNOWN);
-                result = EXIT_FAILURE;
-            }
-        }
-        if (result == 0) // Se não houve erro ao ler o bloco indireto simples
-        {
-            uint32_t *tbl = (uint32_t *)buf;                            // Converte o buffer para um ponteiro de tabela de blocos
-            for (uint32_t j = 0; j < PTRS_PER_BLOCK && bytes_left; ++j) // Percorre os ponteiros na tabela de blocos indiretos
-            {
-                uint32_t n = (bytes_left >= EXT2_BLOCK_SIZE) ? EXT2_BLOCK_SIZE : bytes_left; // Tamanho do bloco a ser copiado
-                uint32_t blk = in.i_block[12] ? tbl[j] : 0;                                  // Obtém o bloco a ser copiado
-
-                if (dump_block(fs, blk, fd, n)) // Copia o bloco para o arquivo de destino
-                {
-                    print_error(ERROR_UNKNOWN);
-                    result = EXIT_FAILURE;
-                    break;
-                }
-                bytes_left -= n; // Atualiza o tamanho restante do arquivo a ser copiado
-            }
-        }
-    }
-
-    if (result == 0 && bytes_left) // Bloco indireto duplo (13)
-    {
-        if (!in.i_block[13]) // Se não houver bloco indireto duplo, não há mais blocos a serem copiados
-        {
-            print_error(ERROR_UNKNOWN);
-            result = EXIT_FAILURE;
-        }
-        else // Se houver bloco indireto duplo, lê os blocos indiretos
-        {
-            unsigned char buf1[EXT2_BLOCK_SIZE], buf2[EXT2_BLOCK_SIZE]; // Buffers para armazenar os blocos indiretos
-            if (fs_read_block(fs, in.i_block[13], buf1) < 0)            // Lê o bloco indireto duplo
-            {
-                print_error(ERROR_UNKNOWN);
-                result = EXIT_FAILURE;
-            }
-            else // Se não houve erro ao ler o bloco indireto duplo
-            {
-                uint32_t *lvl1 = (uint32_t *)buf1; // Converte o buffer para um ponteiro de tabela de blocos indiretos duplos
-
-                for (uint32_t i1 = 0; i1 < PTRS_PER_BLOCK && bytes_left && result == 0; ++i1) // Percorre os ponteiros na tabela de blocos indiretos duplos
-                {
-                    uint32_t l2blk = lvl1[i1];
-                    if (l2blk && fs_read_block(fs, l2blk, buf2) < 0)
-                    {
-                        print_error(ERROR_UNKNOWN);
-                        result = EXIT_FAILURE;
-                        break;
-                    }
-                    uint32_t *lvl2 = (uint32_t *)buf2;
-                    for (uint32_t i2 = 0; i2 < PTRS_PER_BLOCK && bytes_left && result == 0; ++i2)
-                    {
-                        uint32_t blk = l2blk ? lvl2[i2] : 0;
-                        uint32_t n = (bytes_left >= EXT2_BLOCK_SIZE) ? EXT2_BLOCK_SIZE : bytes_left;
-
-                        if (dump_block(fs, blk, fd, n)) // Copia o bloco para o arquivo de destino
-                        {
-                            print_error(ERROR_UNKNOWN);
-                            result = EXIT_FAILURE;
-                            break;
-                        }
-                        bytes_left -= n; // Atualiza o tamanho restante do arquivo a ser copiado
-                    }
-                }
-            }
-        }
+        print_error(ERROR_UNKNOWN);
+        result = EXIT_FAILURE;
     }
 
     fclose(fd);
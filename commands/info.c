@@ -32,8 +32,8 @@ int cmd_info(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     char volume_name[17] = {0};                    // Volume name pode não ser NUL-terminated
     memcpy(volume_name, fs->sb.s_volume_name, 16); // Copia o nome do volume do superbloco
 
-    off_t image_size = lseek(fs->fd, 0, SEEK_END); // Obtém o tamanho total da imagem
-    if (image_size < 0)                            // Verifica se houve erro ao ler o tamanho da imagem
+    off_t image_size = fs->io->size(fs); // Obtém o tamanho total da imagem
+    if (image_size < 0)                  // Verifica se houve erro ao ler o tamanho da imagem
     {
         print_error(ERROR_UNKNOWN);
         return EXIT_FAILURE;
@@ -41,7 +41,7 @@ int cmd_info(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
 
     uint32_t free_blocks = fs->sb.s_free_blocks_count;                                          // Contagem de blocos livres
     uint32_t free_inodes = fs->sb.s_free_inodes_count;                                          // Contagem de inodes livres
-    uint32_t block_size = EXT2_BLOCK_SIZE;                                                      // Fixo em 1 KiB neste projeto
+    uint32_t block_size = fs->block_size;                                                       // Lido do superbloco em fs_open
     uint32_t inode_size = fs->sb.s_inode_size;                                                  // 128 B
     uint32_t group_count = fs->groups_count;                                                    // Número de grupos de blocos
     uint32_t blocks_per_group = fs->sb.s_blocks_per_group;                                      // Contagem de blocos por grupo
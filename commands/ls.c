@@ -1,59 +1,140 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "commands.h"
 
+/**
+ * @brief   Imprime uma entrada de diretório no formato longo (ls -l).
+ *
+ * @param e      Entrada de diretório.
+ * @param inode  Inode da entrada.
+ */
+static void print_long_entry(struct ext2_dir_entry *e, struct ext2_inode *inode)
+{
+    char perm[11]; // Tipo e permissões, no mesmo formato do attr
+    build_perm_string(inode, perm);
+
+    char date[20];
+    time_t mtime = inode->i_mtime;
+    struct tm tm_info;
+    localtime_r(&mtime, &tm_info);
+    strftime(date, sizeof(date), "%d/%m/%Y %H:%M", &tm_info);
+
+    printf("%s %3u %5u %5u %10u %s ", perm, inode->i_links_count, inode->i_uid, inode->i_gid, inode->i_size, date);
+    if (e->file_type == 2) // Diretórios em azul, como no ls simples
+        printf("\033[34m%.*s\033[0m\n", e->name_len, e->name);
+    else
+        printf("%.*s\n", e->name_len, e->name);
+}
+
 /**
  * @brief   Lista o conteúdo de um diretório no sistema de arquivos EXT2.
  *
- * Esta função percorre os blocos de dados do diretório, imprimindo as entradas
- * encontradas, incluindo o número do inode, nome e tipo de arquivo.
+ * Esta função lê de uma só vez todos os blocos de dados do diretório (uma
+ * leitura por sequência de blocos contíguos) e imprime as entradas
+ * encontradas, incluindo o número do inode, nome e tipo de arquivo. No
+ * formato longo, os blocos da tabela de inodes de todas as entradas são
+ * carregados antes, em ordem crescente, e cada entrada é impressa com as
+ * permissões, links, dono, tamanho e data de modificação do seu inode.
  *
  * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
  * @param dir_inode  Ponteiro para o inode do diretório a ser listado.
+ * @param longo      Se diferente de zero, usa o formato longo (ls -l).
  *
  * @return Retorna 0 em caso de sucesso, ou 1 em caso de erro.
  */
-static int list_directory(ext2_fs_t *fs, struct ext2_inode *dir_inode)
+static int list_directory(ext2_fs_t *fs, struct ext2_inode *dir_inode, int longo)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE]; // Buffer para armazenar os dados lidos do bloco
-
-    for (int i = 0; i < 12; ++i) // Percorre os blocos diretos do inode do diretório
+    struct fs_block_run runs[12]; // Sequências de blocos contíguos do diretório
+    uint32_t nruns = 0, nblocks = 0;
+    for (uint32_t i = 0; i < 12; ++i) // Percorre os blocos diretos do inode do diretório
     {
         uint32_t bloco = dir_inode->i_block[i]; // Obtém o número do bloco
         if (bloco == 0)                         // Se o bloco não estiver alocado, pula para o próximo
             continue;
+        if (nruns && runs[nruns - 1].physical + runs[nruns - 1].len == bloco)
+            runs[nruns - 1].len++;
+        else
+            runs[nruns++] = (struct fs_block_run){.logical = i, .physical = bloco, .len = 1};
+        nblocks++;
+    }
 
-        if (fs_read_block(fs, bloco, buf) < 0) // Lê o bloco do diretório
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
+    uint8_t *buf = malloc((size_t)nblocks * fs->block_size + 1); // Todos os blocos do diretório
+    if (!buf || (nruns && fs_read_runs(fs, runs, nruns, buf) < 0)) // Lê os blocos do diretório de uma só vez
+    {
+        free(buf);
+        print_error(ERROR_UNKNOWN);
+        return EXIT_FAILURE;
+    }
 
-        uint32_t offset = 0;             // Inicializa o deslocamento para percorrer o bloco
-        while (offset < EXT2_BLOCK_SIZE) // Percorre o bloco até o final
+    size_t max_ents = (size_t)nblocks * fs->block_size / 12 + 1;  // Cada entrada ocupa ao menos 12 bytes
+    struct ext2_dir_entry **ents = malloc(max_ents * sizeof(*ents)); // Entradas válidas, na ordem do diretório
+    uint32_t *inos = malloc(max_ents * sizeof(*inos));               // Inodes das entradas
+    uint32_t nents = 0;
+    if (!ents || !inos)
+    {
+        free(buf);
+        free(ents);
+        free(inos);
+        print_error(ERROR_UNKNOWN);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t b = 0; b < nblocks; ++b) // Percorre cada bloco até o final
+    {
+        uint8_t *blk = buf + (size_t)b * fs->block_size;
+        uint32_t offset = 0; // Inicializa o deslocamento para percorrer o bloco
+        while (offset < fs->block_size)
         {
-            struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(buf + offset); // Obtém a entrada de diretório a partir do buffer
+            struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(blk + offset); // Obtém a entrada de diretório a partir do buffer
 
             if (entry->rec_len == 0) // Se o comprimento do registro for zero, significa que a entrada está corrompida
                 break;
 
-            if (entry->inode != 0) // Se o inode da entrada for diferente de zero, imprime a entrada
+            if (entry->inode != 0 && nents < max_ents) // Guarda as entradas com inode
             {
-                print_entry(entry);
+                ents[nents] = entry;
+                inos[nents++] = entry->inode;
             }
             offset += entry->rec_len; // Atualiza o deslocamento para a próxima entrada
         }
     }
-    return EXIT_SUCCESS;
+
+    if (longo)
+        fs_icache_prefetch(fs, inos, nents); // Blocos da tabela de inodes em ordem crescente
+
+    int ret = EXIT_SUCCESS;
+    for (uint32_t i = 0; i < nents; ++i) // Imprime na ordem do diretório
+    {
+        if (!longo)
+        {
+            print_entry(ents[i]);
+            continue;
+        }
+        struct ext2_inode inode;
+        if (fs_read_inode(fs, ents[i]->inode, &inode) < 0)
+        {
+            print_error(ERROR_UNKNOWN);
+            ret = EXIT_FAILURE;
+            break;
+        }
+        print_long_entry(ents[i], &inode);
+    }
+
+    free(buf);
+    free(ents);
+    free(inos);
+    return ret;
 }
 
 /**
  * @brief   Comando 'ls' para listar o conteúdo de um diretório ou arquivo.
  *
  * Este comando aceita um argumento opcional que especifica o caminho a ser listado.
- * Se nenhum argumento for fornecido, lista o diretório atual.
+ * Se nenhum argumento for fornecido, lista o diretório atual. Com a opção -l,
+ * lista no formato longo (permissões, links, dono, tamanho e data).
  *
  * @param argc  Número de argumentos passados para o comando.
  * @param argv  Array de strings contendo os argumentos.
@@ -64,6 +145,12 @@ static int list_directory(ext2_fs_t *fs, struct ext2_inode *dir_inode)
  */
 int cmd_ls(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
 {
+    int longo = argc > 1 && strcmp(argv[1], "-l") == 0; // Formato longo
+    if (longo)                                          // Remove a opção dos argumentos
+    {
+        argc--;
+        argv++;
+    }
     if (argc > 2) // Verifica se o número de argumentos é válido
     {
         print_error(ERROR_INVALID_SYNTAX);
@@ -104,7 +191,7 @@ int cmd_ls(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     int resultado;           // Variável para armazenar o resultado da listagem
     if (ext2_is_dir(&inode)) // Verifica se o inode é um diretório
     {
-        resultado = list_directory(fs, &inode);
+        resultado = list_directory(fs, &inode, longo);
     }
     else // Se não for um diretório, imprime erro
     {
@@ -22,7 +22,7 @@
  */
 static int dir_add_entry(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t dir_ino, uint32_t new_ino, char *name, uint8_t file_type)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE];
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE];
     uint16_t tamanho_necessario = rec_len_needed((uint8_t)strlen(name));
 
     // Percorre os blocos diretos do diretório
@@ -33,20 +33,20 @@ static int dir_add_entry(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t d
         // Se o bloco não existe, aloca um novo bloco para o diretório
         if (!bloco)
         {
-            if (fs_alloc_block(fs, &bloco) < 0)
+            if (fs_inode_alloc_block(fs, dir_ino, dir_inode, i, &bloco) < 0) // Perto do bloco anterior, pela janela de reserva do diretório
             {
                 print_error(ERROR_UNKNOWN);
                 return EXIT_FAILURE;
             }
             dir_inode->i_block[i] = bloco;
-            dir_inode->i_size += EXT2_BLOCK_SIZE;
-            dir_inode->i_blocks += EXT2_BLOCK_SIZE / 512;
+            dir_inode->i_size += fs->block_size;
+            dir_inode->i_blocks += fs->block_size / 512;
 
             // Cria a nova entrada ocupando todo o bloco
-            memset(buf, 0, EXT2_BLOCK_SIZE);
+            memset(buf, 0, fs->block_size);
             struct ext2_dir_entry *entrada = (struct ext2_dir_entry *)buf; // Inicia a entrada de diretório
             entrada->inode = new_ino;
-            entrada->rec_len = EXT2_BLOCK_SIZE;
+            entrada->rec_len = fs->block_size;
             entrada->name_len = (uint8_t)strlen(name);
             entrada->file_type = file_type;
             memcpy(entrada->name, name, entrada->name_len); // Copia o nome para a entrada
@@ -72,7 +72,7 @@ static int dir_add_entry(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t d
 
         uint32_t pos = 0;
         // Percorre as entradas do bloco procurando espaço livre
-        while (pos < EXT2_BLOCK_SIZE)
+        while (pos < fs->block_size)
         {
             struct ext2_dir_entry *entrada = (struct ext2_dir_entry *)(buf + pos); // Obtém a entrada de diretório atual
             if (entrada->rec_len == 0)
@@ -198,8 +198,8 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    uint32_t novo_inode;                                          // Variável para armazenar o número do novo inode
-    if (fs_alloc_inode(fs, EXT2_S_IFDIR | 0755, &novo_inode) < 0) // Aloca um novo inode para o diretório
+    uint32_t novo_inode;                                                     // Variável para armazenar o número do novo inode
+    if (fs_alloc_inode(fs, EXT2_S_IFDIR | 0755, inode_pai, &novo_inode) < 0) // Aloca um novo inode para o diretório
     {
         free(novo_caminho);
         free(caminho_pai);
@@ -207,8 +207,8 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    uint32_t novo_bloco;                     // Aloca o primeiro bloco do novo diretório
-    if (fs_alloc_block(fs, &novo_bloco) < 0) // Aloca um novo bloco para o diretório
+    uint32_t novo_bloco;                                                             // Aloca o primeiro bloco do novo diretório
+    if (fs_alloc_block(fs, fs_block_goal(fs, novo_inode, NULL, 0), &novo_bloco) < 0) // Aloca um novo bloco para o diretório, no grupo do seu inode
     {
         free(novo_caminho);
         free(caminho_pai);
@@ -221,8 +221,8 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     novo_inode_struct.i_mode = EXT2_S_IFDIR | 0755;
     novo_inode_struct.i_uid = 0;
     novo_inode_struct.i_gid = 0;
-    novo_inode_struct.i_size = EXT2_BLOCK_SIZE;
-    novo_inode_struct.i_blocks = EXT2_BLOCK_SIZE / 512;
+    novo_inode_struct.i_size = fs->block_size;
+    novo_inode_struct.i_blocks = fs->block_size / 512;
     novo_inode_struct.i_links_count = 2; // '.' e '..'
     time_t agora = time(NULL);
     novo_inode_struct.i_atime = novo_inode_struct.i_ctime = novo_inode_struct.i_mtime = (uint32_t)agora; // Define os tempos de acesso, criação e modificação
@@ -237,8 +237,8 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     }
 
     // Cria as entradas '.' e '..' no novo diretório
-    uint8_t buffer[EXT2_BLOCK_SIZE];
-    memset(buffer, 0, EXT2_BLOCK_SIZE);
+    uint8_t buffer[EXT2_MAX_BLOCK_SIZE];
+    memset(buffer, 0, fs->block_size);
     struct ext2_dir_entry *ponto = (struct ext2_dir_entry *)buffer; // Posição da entrada '.'
     ponto->inode = novo_inode;
     ponto->name_len = 1;
@@ -250,7 +250,7 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     ponto_ponto->inode = inode_pai;
     ponto_ponto->name_len = 2;
     ponto_ponto->file_type = EXT2_FT_DIR;
-    ponto_ponto->rec_len = EXT2_BLOCK_SIZE - ponto->rec_len;
+    ponto_ponto->rec_len = fs->block_size - ponto->rec_len;
     ponto_ponto->name[0] = '.';
     ponto_ponto->name[1] = '.';
 
@@ -270,8 +270,9 @@ int cmd_mkdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    inode_pai_struct.i_links_count++;                 // Atualiza o link count do diretório pai
-    fs_write_inode(fs, inode_pai, &inode_pai_struct); // Escreve o inode do diretório pai no disco
+    inode_pai_struct.i_links_count++;                   // Atualiza o link count do diretório pai
+    fs_write_inode(fs, inode_pai, &inode_pai_struct);   // Escreve o inode do diretório pai no disco
+    fs_dcache_add(fs, inode_pai, nome_dir, novo_inode); // Substitui a entrada negativa do nome na cache de entradas
 
     free(novo_caminho);
     free(caminho_pai);
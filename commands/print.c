@@ -139,10 +139,65 @@ void print_inode(ext2_fs_t *fs, uint32_t ino)
     printf("location file fragment.........: %u\n", in.i_faddr);
 }
 
+/**
+ * @brief Imprime as estatísticas das caches em memória do sistema de arquivos EXT2.
+ *
+ * Esta função mostra a ocupação, os blocos/inodes sujos, os acertos, as faltas
+ * e as escritas realizadas pelas caches de blocos, de inodes e de entradas de diretório,
+ * além do estado do índice de espaço livre.
+ *
+ * @param fs Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void print_cache(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    fs_icache_t *ic = &fs->icache;
+    fs_dcache_t *dc = &fs->dcache;
+    uint32_t free_ents = 0;
+    for (struct fs_dentry *d = dc->free; d; d = d->next) // Conta as entradas descartadas
+        free_ents++;
+    fs_freeidx_t *fi = &fs->freeidx;
+    uint32_t loaded = 0, runs = 0;
+    for (uint32_t g = 0; fi->groups && g < fs->groups_count; ++g) // Conta os grupos já indexados
+        if (fi->groups[g].loaded)
+        {
+            loaded++;
+            runs += fi->groups[g].count;
+        }
+    printf("Block Cache:\n");
+    printf("    blocks in use............: %u/%u\n", bc->used, bc->capacity);
+    printf("    dirty blocks.............: %u\n", bc->dirty);
+    printf("    hits.....................: %llu\n", (unsigned long long)bc->hits);
+    printf("    misses...................: %llu\n", (unsigned long long)bc->misses);
+    printf("    writebacks...............: %llu\n", (unsigned long long)bc->writebacks);
+    printf("    background writes........: %llu (%llu rounds)\n", (unsigned long long)bc->flushed, (unsigned long long)fs->flusher.rounds);
+    printf("Inode Cache:\n");
+    printf("    inodes in use............: %u/%u\n", ic->used, ic->capacity);
+    printf("    dirty inodes.............: %u\n", ic->dirty);
+    printf("    hits.....................: %llu\n", (unsigned long long)ic->hits);
+    printf("    misses...................: %llu\n", (unsigned long long)ic->misses);
+    printf("    writebacks...............: %llu\n", (unsigned long long)ic->writebacks);
+    printf("    extent map hits..........: %llu\n", (unsigned long long)ic->extent_hits);
+    printf("    extent maps built........: %llu\n", (unsigned long long)ic->extent_builds);
+    printf("    readahead blocks.........: %llu\n", (unsigned long long)ic->readahead);
+    printf("Dentry Cache:\n");
+    printf("    entries in use...........: %u/%u\n", dc->used - free_ents, dc->capacity);
+    printf("    negative entries.........: %u\n", dc->negative);
+    printf("    hits.....................: %llu\n", (unsigned long long)dc->hits);
+    printf("    misses...................: %llu\n", (unsigned long long)dc->misses);
+    printf("    reverse hits.............: %llu\n", (unsigned long long)dc->rhits);
+    printf("    reverse misses...........: %llu\n", (unsigned long long)dc->rmisses);
+    printf("Free Space Index:\n");
+    printf("    groups indexed...........: %u/%u\n", loaded, fs->groups_count);
+    printf("    free runs................: %u\n", runs);
+    printf("    bitmap loads.............: %llu\n", (unsigned long long)fi->loads);
+}
+
 /**
  * @brief Comando para imprimir informações do sistema de arquivos EXT2.
  *
- * Este comando aceita argumentos para imprimir o superbloco, grupos de blocos ou um inode específico.
+ * Este comando aceita argumentos para imprimir o superbloco, grupos de blocos, um inode específico
+ * ou as estatísticas das caches.
  *
  * @param argc Número de argumentos.
  * @param argv Array de argumentos.
@@ -189,6 +244,16 @@ int cmd_print(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         print_inode(fs, ino);
         return EXIT_SUCCESS;
     }
+    if (strcmp(argv[1], "cache") == 0) // Verifica se o comando é para imprimir as estatísticas das caches
+    {
+        if (argc != 2) // Verifica se o número de argumentos é correto
+        {
+            print_error(ERROR_INVALID_SYNTAX);
+            return EXIT_FAILURE;
+        }
+        print_cache(fs);
+        return EXIT_SUCCESS;
+    }
     print_error(ERROR_INVALID_SYNTAX); // Se nenhum dos comandos for reconhecido, imprime erro de sintaxe
     return EXIT_FAILURE;
 }
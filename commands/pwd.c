@@ -24,14 +24,13 @@ int cmd_pwd(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    char *current_path = fs_get_path(fs, *cwd); // Obtém o caminho absoluto do diretório atual
-    if (!current_path)                          // Verifica se a obtenção do caminho foi bem-sucedida
+    const char *current_path = fs_cwd_path(fs, *cwd); // Obtém o caminho absoluto do diretório atual
+    if (!current_path)                                // Verifica se a obtenção do caminho foi bem-sucedida
     {
         print_error(ERROR_DIRECTORY_NOT_FOUND);
         return EXIT_FAILURE;
     }
 
     printf("%s\n", current_path); // Imprime o caminho
-    free(current_path);           // Libera a memória alocada para o caminho
     return EXIT_SUCCESS;
 }
@@ -19,15 +19,15 @@
  */
 static int rename_entry_block(ext2_fs_t *fs, uint32_t blk, uint32_t target_ino, char *newname)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE];        // Buffer para armazenar o bloco lido
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE];    // Buffer para armazenar o bloco lido
     if (fs_read_block(fs, blk, buf) < 0) // Lê o bloco do diretório
     {
         print_error(ERROR_UNKNOWN);
         return EXIT_FAILURE;
     }
 
-    uint32_t pos = 0;             // Posição atual no buffer
-    while (pos < EXT2_BLOCK_SIZE) // Percorre o bloco até o final
+    uint32_t pos = 0;            // Posição atual no buffer
+    while (pos < fs->block_size) // Percorre o bloco até o final
     {
         struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(buf + pos); // Obtém a entrada de diretório atual
 
@@ -180,6 +180,10 @@ int cmd_rename(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
+    fs_dcache_invalidate(fs, parent_inode_num, old_inode);    // Descarta o nome antigo da cache de entradas
+    fs_dcache_add(fs, parent_inode_num, new_name, old_inode); // Registra o novo nome na cache de entradas
+    fs_cwd_invalidate(fs);                                    // O diretório renomeado pode fazer parte do caminho corrente
+
     free(old_full_path);
     free(dup_path);
     free(parent_path);
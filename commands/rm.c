@@ -5,112 +5,10 @@
 
 #include "commands.h"
 
-/**
- * @brief   Libera um bloco no sistema de arquivos EXT2.
- *
- * Esta função marca um bloco como livre, atualizando o bitmap de blocos e o descritor de grupo correspondente.
- *
- * @param fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param blk Número do bloco a ser liberado.
- *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se o bloco já estiver livre).
- */
-int fs_free_blocks(ext2_fs_t *fs, uint32_t blk)
-{
-    struct ext2_group_desc gd;
-    uint8_t bitmap[EXT2_BLOCK_SIZE];
-
-    /* Grupo ao qual o bloco pertence */
-    uint32_t group = (blk - fs->sb.s_first_data_block) / fs->sb.s_blocks_per_group;
-
-    if (fs_read_group_desc(fs, group, &gd) < 0)
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    if (fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0)
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    uint32_t idx = (blk - fs->sb.s_first_data_block) % fs->sb.s_blocks_per_group;
-
-    /* bloco já livre → inconsistência */
-    if (!(bitmap[BIT_BYTE(idx)] & BIT_MASK(idx)))
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    bitmap[BIT_BYTE(idx)] &= ~BIT_MASK(idx); /* marca como livre */
-    gd.bg_free_blocks_count++;
-    fs->sb.s_free_blocks_count++;
-
-    if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0)
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    if (fs_write_group_desc(fs, group, &gd) < 0)
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    return fs_sync_super(fs);
-}
-
-/**
- * @brief   Libera uma cadeia de blocos indiretos (simples ou duplos).
- *
- * Esta função libera todos os blocos referenciados por um bloco indireto, recursivamente.
- * Se a profundidade for 1, libera blocos indiretos simples; se for 2, libera blocos indiretos duplos.
- *
- * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param blk    Bloco a ser liberado.
- * @param depth  Profundidade da cadeia (1 para indireto simples, 2 para indireto duplo).
- *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro.
- */
-int free_indirect_chain(ext2_fs_t *fs, uint32_t blk, int depth)
-{
-    if (!blk)
-        return EXIT_SUCCESS;
-
-    uint32_t ptrs[PTRS_PER_BLOCK];        // Ponteiros para blocos
-    if (fs_read_block(fs, blk, ptrs) < 0) // Lê o bloco indireto
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    if (depth == 1) // Se for indireto simples
-    {
-        for (size_t i = 0; i < PTRS_PER_BLOCK; ++i)     // Percorre os ponteiros
-            if (ptrs[i] && fs_free_blocks(fs, ptrs[i])) // Libera blocos diretos
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-    }
-    else // depth == 2
-    {
-        for (size_t i = 0; i < PTRS_PER_BLOCK; ++i)                     // Percorre os ponteiros
-            if (ptrs[i] && free_indirect_chain(fs, ptrs[i], depth - 1)) // Libera blocos indiretos
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-    }
-
-    return fs_free_blocks(fs, blk); // Libera o bloco indireto em si
-}
-
 /**
  * @brief   Libera todos os blocos de dados associados a um inode.
  *
- * Esta função libera todos os blocos diretos, indiretos simples e indiretos duplos de um inode,
+ * Esta função libera todos os blocos diretos e indiretos (simples, duplos e triplos) de um inode,
  * além de zerar os ponteiros e atualizar as estatísticas do inode.
  *
  * @param fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
@@ -120,29 +18,7 @@ int free_indirect_chain(ext2_fs_t *fs, uint32_t blk, int depth)
  */
 int free_inode_block(ext2_fs_t *fs, struct ext2_inode *ino)
 {
-    // Zera os ponteiros e estatísticas do inode
-    for (int i = 0; i < 12; ++i) // Libera diretos
-    {
-        if (ino->i_block[i] && fs_free_blocks(fs, ino->i_block[i])) // Libera diretos
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
-    }
-
-    if (free_indirect_chain(fs, ino->i_block[12], 1)) // Libera indiretos simples
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    if (free_indirect_chain(fs, ino->i_block[13], 2)) // Libera indireto duplo
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    if (free_indirect_chain(fs, ino->i_block[14], 3) < 0) // Libera indireto triplo
+    if (free_inode_blocks(fs, ino) < 0) // Libera os blocos diretos e indiretos
     {
         print_error(ERROR_UNKNOWN);
         return EXIT_FAILURE;
@@ -171,7 +47,7 @@ int free_inode_block(ext2_fs_t *fs, struct ext2_inode *ino)
  */
 int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t target_ino)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE]; // Buffer para armazenar o bloco lido
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE]; // Buffer para armazenar o bloco lido
 
     for (int i = 0; i < 12; ++i) // Percorre os blocos diretos do diretório
     {
@@ -188,7 +64,7 @@ int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t ta
         uint32_t off = 0; // Posição atual no buffer
         struct ext2_dir_entry *prev = NULL;
 
-        while (off < EXT2_BLOCK_SIZE) // Percorre o bloco até o final
+        while (off < fs->block_size) // Percorre o bloco até o final
         {
             struct ext2_dir_entry *e = (void *)(buf + off); // Obtém a entrada de diretório atual
             if (!e->rec_len)                                // Se a entrada não tiver comprimento, significa que não há mais entradas
@@ -201,7 +77,7 @@ int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *dir_inode, uint32_t ta
                 else // se for a primeira entrada do bloco, marcaremos ela como livre estendendo-a até o fim do bloco
                 {
                     e->inode = 0;
-                    e->rec_len = EXT2_BLOCK_SIZE;
+                    e->rec_len = fs->block_size;
                 }
 
                 if (fs_write_block(fs, bloco, buf) < 0) // Atualiza o bloco com a entrada removida
@@ -303,6 +179,9 @@ int cmd_rm(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
+    fs_dcache_invalidate(fs, parent_ino, file_ino);                // Descarta as entradas em cache que apontam para o arquivo
+    fs_dcache_add(fs, parent_ino, strrchr(full_path, '/') + 1, 0); // Registra o nome removido como entrada negativa
+
     if (free_inode_block(fs, &file_inode)) // Libera os blocos do inode
     {
         free(full_path);
@@ -6,107 +6,6 @@
 #include "commands.h"
 #include "utils.h"
 
-/**
- * @brief Libera uma cadeia de blocos indiretos.
- *
- * Esta função libera todos os blocos em uma cadeia de blocos indiretos, recursivamente,
- * até a profundidade especificada. Se a profundidade for 1, libera blocos indiretos simples;
- * se for 2, libera blocos indiretos duplos; e se for 3, libera blocos indiretos triplos.
- *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param blk   Número do bloco a ser liberado.
- * @param depth Profundidade da cadeia de blocos indiretos.
- *
- * @return Retorna 0 em caso de sucesso ou 1 em caso de erro.
- */
-static int free_indirect_chain(ext2_fs_t *fs, uint32_t blk, int depth)
-{
-    if (!blk) // Se o bloco for nulo, não há nada a liberar
-    {
-        return EXIT_SUCCESS;
-    }
-    uint32_t ptrs[EXT2_BLOCK_SIZE / sizeof(uint32_t)]; // Array para armazenar os ponteiros dos blocos indiretos
-    if (fs_read_block(fs, blk, ptrs) < 0)              // Lê o bloco indireto
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    for (int i = 0; i < (int)(EXT2_BLOCK_SIZE / sizeof(uint32_t)); i++) // Percorre todos os ponteiros no bloco indireto
-    {
-        uint32_t b = ptrs[i];
-        if (!b)
-            continue;
-        if (depth > 1) // Se a profundidade for maior que 1, libera blocos indiretos recursivamente
-        {
-            if (free_indirect_chain(fs, b, depth - 1) == EXIT_FAILURE) // Libera blocos indiretos
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-        }
-        else // Se a profundidade for 1, libera blocos indiretos simples
-        {
-            if (fs_free_block(fs, b) < 0)
-            {
-                print_error(ERROR_UNKNOWN);
-                return EXIT_FAILURE;
-            }
-        }
-    }
-    if (fs_free_block(fs, blk) < 0) // Libera o bloco indireto em si
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    return EXIT_SUCCESS;
-}
-
-/**
- * @brief Libera os blocos de dados de um inode e atualiza o bitmap.
- *
- * Esta função libera todos os blocos diretos, indiretos simples, duplos e triplos de um inode,
- * além de atualizar o bitmap de blocos livres do sistema de arquivos.
- *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param inode Ponteiro para o inode cujos blocos serão liberados.
- *
- * @return Retorna 0 em caso de sucesso ou 1 em caso de erro.
- */
-static int free_inode_blocks_logged(ext2_fs_t *fs, struct ext2_inode *inode)
-{
-    for (int i = 0; i < 12; i++) // Libera blocos diretos
-    {
-        uint32_t b = inode->i_block[i];
-        if (!b)
-        {
-            continue;
-        }
-        if (fs_free_block(fs, b) < 0)
-        {
-            print_error(ERROR_UNKNOWN);
-            return EXIT_FAILURE;
-        }
-    }
-
-    if (free_indirect_chain(fs, inode->i_block[12], 1) == EXIT_FAILURE) // Libera indireto simples
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    if (free_indirect_chain(fs, inode->i_block[13], 2) == EXIT_FAILURE) // Libera indireto duplo
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-    if (free_indirect_chain(fs, inode->i_block[14], 3) == EXIT_FAILURE) // Libera indireto triplo
-    {
-        print_error(ERROR_UNKNOWN);
-        return EXIT_FAILURE;
-    }
-
-    return EXIT_SUCCESS;
-}
-
 /**
  * @brief Verifica se um diretório está vazio.
  *
@@ -120,8 +19,8 @@ static int free_inode_blocks_logged(ext2_fs_t *fs, struct ext2_inode *inode)
  */
 static int is_directory_empty(ext2_fs_t *fs, struct ext2_inode *dir_inode)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE]; // Buffer para armazenar os blocos lidos
-    for (int i = 0; i < 12; i++)  // Percorre todos os blocos diretos
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE]; // Buffer para armazenar os blocos lidos
+    for (int i = 0; i < 12; i++)      // Percorre todos os blocos diretos
     {
         uint32_t b = dir_inode->i_block[i]; // Obtém o número do bloco
         if (!b)
@@ -134,7 +33,7 @@ static int is_directory_empty(ext2_fs_t *fs, struct ext2_inode *dir_inode)
         }
 
         uint32_t off = 0;
-        while (off < EXT2_BLOCK_SIZE) // Percorre todas as entradas do diretório
+        while (off < fs->block_size) // Percorre todas as entradas do diretório
         {
             struct ext2_dir_entry *e = (void *)(buf + off); // Obtém a entrada de diretório
             if (e->rec_len == 0)                            // Se o comprimento da entrada for 0, termina a iteração
@@ -166,8 +65,8 @@ static int is_directory_empty(ext2_fs_t *fs, struct ext2_inode *dir_inode)
  */
 static int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *parent_inode, uint32_t target_ino)
 {
-    uint8_t buf[EXT2_BLOCK_SIZE]; // Buffer para armazenar o bloco lido
-    for (int i = 0; i < 12; i++)  // Percorre os blocos diretos do diretório
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE]; // Buffer para armazenar o bloco lido
+    for (int i = 0; i < 12; i++)      // Percorre os blocos diretos do diretório
     {
         uint32_t b = parent_inode->i_block[i]; // Obtém o número do bloco
         if (!b)
@@ -180,7 +79,7 @@ static int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *parent_inode, u
 
         uint32_t off = 0;
         struct ext2_dir_entry *prev = NULL; // Variável para armazenar a entrada anterior
-        while (off < EXT2_BLOCK_SIZE)       // Percorre o bloco até o final
+        while (off < fs->block_size)        // Percorre o bloco até o final
         {
             struct ext2_dir_entry *e = (void *)(buf + off); // Obtém a entrada de diretório atual
 
@@ -193,7 +92,7 @@ static int dir_remove_entry_rm(ext2_fs_t *fs, struct ext2_inode *parent_inode, u
                 else // Se for a primeira entrada do bloco, marcaremos ela como livre estendendo-a até o fim do bloco
                 {
                     e->inode = 0;
-                    e->rec_len = EXT2_BLOCK_SIZE;
+                    e->rec_len = fs->block_size;
                 }
                 if (fs_write_block(fs, b, buf) < 0) // Atualiza o bloco com a entrada removida
                 {
@@ -290,9 +189,13 @@ int cmd_rmdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
+    fs_dcache_purge(fs, dir_ino);                                  // Descarta as entradas em cache do diretório removido
+    fs_dcache_add(fs, parent_ino, strrchr(full_path, '/') + 1, 0); // Registra o nome removido como entrada negativa
+    fs_cwd_invalidate(fs);                                         // O diretório removido pode ser o diretório corrente
+
     parent_inode.i_links_count--;
-    fs_write_inode(fs, parent_ino, &parent_inode);                // Atualiza o inode do diretório pai
-    if (free_inode_blocks_logged(fs, &dir_inode) == EXIT_FAILURE) // Libera os blocos do inode do diretório
+    fs_write_inode(fs, parent_ino, &parent_inode); // Atualiza o inode do diretório pai
+    if (free_inode_blocks(fs, &dir_inode) < 0)     // Libera os blocos do inode do diretório
     {
         free(full_path);
         free(parent_path);
@@ -307,8 +210,6 @@ int cmd_rmdir(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         return EXIT_FAILURE;
     }
 
-    // Sincroniza o superbloco
-    fs_sync_super(fs);
     free(full_path);
     free(parent_path);
     return EXIT_SUCCESS;
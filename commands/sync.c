@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "commands.h"
+
+/**
+ * @brief Grava na imagem todas as alterações pendentes.
+ *
+ * Esta função escreve os blocos modificados que estão na cache de blocos
+ * e o superbloco na imagem do sistema de arquivos.
+ *
+ * @param argc Número de argumentos passados para o comando.
+ * @param argv Array de strings contendo os argumentos do comando.
+ * @param fs Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param cwd Ponteiro para o número do inode do diretório atual (não utilizado).
+ * @return Retorna 0 em caso de sucesso, ou 1 em caso de erro.
+ */
+int cmd_sync(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
+{
+    (void)argv; // Ignora argumentos além do comando
+    (void)cwd;  // Diretório corrente não utilizado
+
+    if (argc != 1) // Verifica se o comando foi chamado corretamente
+    {
+        print_error(ERROR_INVALID_SYNTAX);
+        return EXIT_FAILURE;
+    }
+
+    if (fs_sync(fs) < 0) // Escreve os blocos sujos e o superbloco
+    {
+        print_error(ERROR_UNKNOWN);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
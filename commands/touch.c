@@ -105,7 +105,7 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
 
     // Aloca um novo inode para o arquivo
     uint32_t new_inode_num;
-    if (fs_alloc_inode(fs, EXT2_S_IFREG | 0644, &new_inode_num) < 0)
+    if (fs_alloc_inode(fs, EXT2_S_IFREG | 0644, parent_inode_num, &new_inode_num) < 0) // No grupo do diretório pai, se possível
     {
         free(full_path);
         free(parent_path);
@@ -134,7 +134,7 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     }
 
     // Insere a entrada do novo arquivo no diretório pai
-    uint8_t buf[EXT2_BLOCK_SIZE];
+    uint8_t buf[EXT2_MAX_BLOCK_SIZE];
     uint16_t entry_size = rec_len_needed((uint8_t)strlen(file_name));
     int inserted = 0;
 
@@ -145,7 +145,7 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         if (!block)
         {
             // Se não há bloco, aloca um novo bloco para o diretório
-            if (fs_alloc_block(fs, &block) < 0)
+            if (fs_inode_alloc_block(fs, parent_inode_num, &parent_inode, i, &block) < 0) // Perto do bloco anterior, pela janela de reserva do diretório
             {
                 free(full_path);
                 free(parent_path);
@@ -153,16 +153,16 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
                 return EXIT_FAILURE;
             }
             parent_inode.i_block[i] = block;
-            parent_inode.i_size += EXT2_BLOCK_SIZE;
-            parent_inode.i_blocks += EXT2_BLOCK_SIZE / 512;
-            memset(buf, 0, EXT2_BLOCK_SIZE);
+            parent_inode.i_size += fs->block_size;
+            parent_inode.i_blocks += fs->block_size / 512;
+            memset(buf, 0, fs->block_size);
 
             // Cria a primeira entrada no bloco
             struct ext2_dir_entry *entry = (struct ext2_dir_entry *)buf;
             entry->inode = new_inode_num;
             entry->name_len = (uint8_t)strlen(file_name);
             entry->file_type = EXT2_FT_REG_FILE;
-            entry->rec_len = EXT2_BLOCK_SIZE;
+            entry->rec_len = fs->block_size;
             memcpy(entry->name, file_name, entry->name_len);
 
             // Escreve o bloco no disco
@@ -187,7 +187,7 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
         }
         uint32_t pos = 0;
         // Percorre as entradas do diretório procurando espaço para inserir a nova entrada
-        while (pos < EXT2_BLOCK_SIZE)
+        while (pos < fs->block_size)
         {
             struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(buf + pos);
             if (entry->rec_len == 0)
@@ -233,6 +233,9 @@ int cmd_touch(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd)
     // Atualiza o inode do diretório pai com as alterações
     fs_write_inode(fs, parent_inode_num, &parent_inode);
 
+    // Substitui a entrada negativa do nome na cache de entradas de diretório
+    fs_dcache_add(fs, parent_inode_num, file_name, new_inode_num);
+
     printf("arquivo criado com inode %u.\n", new_inode_num);
     free(full_path);
     free(parent_path);
@@ -0,0 +1,182 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ext2.h"
+
+/**
+ * @file    cache.h
+ *
+ * Estruturas das caches em memória usadas pelo sistema de arquivos.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define BCACHE_DEFAULT_BLOCKS 1024  // Capacidade padrão da cache de blocos (em blocos)
+#define ICACHE_DEFAULT_INODES 256   // Capacidade padrão da cache de inodes (em inodes)
+#define DCACHE_DEFAULT_ENTRIES 1024 // Capacidade padrão da cache de entradas de diretório
+
+#define FLUSHER_DIRTY_PERCENT 25 // Porcentagem da cache de blocos suja que dispara o flusher
+#define FLUSHER_AGE_MS 5000      // Idade máxima (ms) de um bloco sujo antes de o flusher gravá-lo
+#define FLUSHER_TICK_MS 500      // Intervalo (ms) entre as verificações do flusher
+#define FLUSHER_BATCH_BLOCKS 256 // Máximo de blocos copiados e gravados por rodada do flusher
+
+/* --------------- Cache de blocos --------------- */
+
+struct fs_buf // Buffer de um bloco mantido em cache
+{
+    uint32_t block;       // Número do bloco armazenado
+    uint8_t dirty;        // 1 se o conteúdo ainda não foi escrito na imagem
+    uint32_t gen;         // Incrementado a cada alteração (o flusher só limpa o que gravou)
+    uint64_t dirty_since; // Momento (ms, relógio monotônico) em que o buffer ficou sujo
+    struct fs_buf *hnext; // Próximo buffer na mesma lista da tabela hash
+    struct fs_buf *prev;  // Buffer usado mais recentemente (lista LRU)
+    struct fs_buf *next;  // Buffer usado menos recentemente (lista LRU)
+    uint8_t *data;        // Conteúdo do bloco
+};
+
+typedef struct // Cache de blocos com despejo LRU e escrita adiada
+{
+    struct fs_buf *bufs;     // Vetor com todos os buffers pré-alocados
+    uint8_t *data;           // Área contígua com os dados de todos os buffers
+    struct fs_buf **hash;    // Tabela hash (número do bloco -> buffer)
+    uint32_t hash_mask;      // Máscara para o índice da tabela hash
+    struct fs_buf *lru_head; // Buffer usado mais recentemente
+    struct fs_buf *lru_tail; // Buffer usado menos recentemente (candidato ao despejo)
+    uint32_t capacity;       // Número máximo de buffers
+    uint32_t used;           // Número de buffers em uso
+    uint32_t dirty;          // Número de buffers sujos
+    uint64_t hits;           // Acessos atendidos pela cache
+    uint64_t misses;         // Acessos que precisaram ler da imagem
+    uint64_t writebacks;     // Blocos escritos na imagem
+    uint64_t flushed;        // Blocos escritos pelo flusher em segundo plano
+} fs_bcache_t;
+
+typedef struct // Thread que grava os blocos sujos em segundo plano
+{
+    pthread_t thread;     // Thread do flusher
+    pthread_mutex_t lock; // Protege o sistema de arquivos (o shell o segura durante cada comando)
+    pthread_cond_t wake;  // Acorda o flusher (limite de blocos sujos atingido ou parada)
+    pthread_cond_t idle;  // Sinalizado quando uma rodada termina
+    int running;          // 1 se a thread foi criada
+    int stop;             // Pede o fim da thread
+    int busy;             // 1 enquanto uma rodada grava blocos fora do lock
+    uint32_t dirty_limit; // Blocos sujos que disparam uma rodada
+    uint8_t *copy;        // Cópia dos blocos gravados na rodada
+    uint64_t rounds;      // Rodadas executadas
+} fs_flusher_t;
+
+/* --------------- Cache de inodes --------------- */
+
+struct fs_extent // Sequência de blocos lógicos alocados em blocos físicos contíguos
+{
+    uint32_t logical;  // Primeiro bloco lógico
+    uint32_t physical; // Primeiro bloco físico
+    uint32_t len;      // Número de blocos
+};
+
+struct fs_inode_ent // Inode decodificado mantido em cache
+{
+    struct ext2_inode inode;    // Conteúdo do inode
+    uint32_t ino;               // Número do inode (0 se a entrada estiver livre)
+    uint32_t refcount;          // Número de referências obtidas com fs_iget
+    uint8_t dirty;              // 1 se o inode ainda não foi escrito na tabela de inodes
+    uint8_t mapped;             // 1 se a lista de extents já foi montada
+    uint32_t prealloc_block;    // Próximo bloco da janela de reserva do inode
+    uint32_t prealloc_count;    // Blocos restantes na janela de reserva (livres no bitmap, reservados no índice de espaço livre)
+    uint32_t nextents;          // Número de extents na lista
+    struct fs_extent *extents;  // Extents do arquivo em ordem de bloco lógico (buracos não aparecem)
+    uint32_t ra_next;           // Bloco lógico esperado na próxima leitura sequencial
+    uint32_t ra_window;         // Janela atual da leitura antecipada em blocos (0 fora de leitura sequencial)
+    uint32_t ra_end;            // Primeiro bloco lógico ainda não pedido por leitura antecipada
+    struct fs_inode_ent *hnext; // Próxima entrada na mesma lista da tabela hash
+    struct fs_inode_ent *prev;  // Entrada usada mais recentemente (lista LRU)
+    struct fs_inode_ent *next;  // Entrada usada menos recentemente (lista LRU)
+};
+
+typedef struct // Cache de inodes com contagem de referências e escrita adiada
+{
+    struct fs_inode_ent *ents;     // Vetor com todas as entradas pré-alocadas
+    struct fs_inode_ent **hash;    // Tabela hash (número do inode -> entrada)
+    uint32_t hash_mask;            // Máscara para o índice da tabela hash
+    struct fs_inode_ent *lru_head; // Entrada usada mais recentemente
+    struct fs_inode_ent *lru_tail; // Entrada usada menos recentemente
+    uint32_t capacity;             // Número máximo de entradas
+    uint32_t used;                 // Número de entradas em uso
+    uint32_t dirty;                // Número de entradas sujas
+    uint64_t hits;                 // Acessos atendidos pela cache
+    uint64_t misses;               // Acessos que precisaram ler a tabela de inodes
+    uint64_t writebacks;           // Inodes escritos na tabela de inodes
+    uint64_t extent_hits;          // Consultas atendidas por uma lista de extents já montada
+    uint64_t extent_builds;        // Listas de extents montadas a partir do mapa de blocos
+    uint64_t readahead;            // Blocos pedidos ao backend por leitura antecipada
+} fs_icache_t;
+
+/* --------------- Cache de entradas de diretório --------------- */
+
+struct fs_dentry // Associação (diretório pai, nome) -> inode mantida em cache
+{
+    uint32_t parent;              // Inode do diretório que contém o nome
+    uint32_t ino;                 // Inode do nome (0 para entrada negativa: o nome não existe)
+    uint8_t name_len;             // Comprimento do nome
+    char name[EXT2_NAME_LEN + 1]; // Nome (terminado com '\0')
+    struct fs_dentry *hnext;      // Próxima entrada na mesma lista da tabela hash
+    struct fs_dentry *rhnext;     // Próxima entrada na mesma lista da tabela reversa
+    struct fs_dentry *prev;       // Entrada usada mais recentemente (lista LRU)
+    struct fs_dentry *next;       // Entrada usada menos recentemente (lista LRU)
+};
+
+typedef struct // Cache de entradas de diretório com entradas negativas e índice reverso
+{
+    struct fs_dentry *ents;     // Vetor com todas as entradas pré-alocadas
+    struct fs_dentry **hash;    // Tabela hash ((pai, nome) -> entrada)
+    struct fs_dentry **rhash;   // Tabela reversa (inode -> entrada com seu pai e nome)
+    uint32_t hash_mask;         // Máscara para o índice da tabela hash
+    struct fs_dentry *lru_head; // Entrada usada mais recentemente
+    struct fs_dentry *lru_tail; // Entrada usada menos recentemente
+    struct fs_dentry *free;     // Lista de entradas livres (invalidadas)
+    uint32_t capacity;          // Número máximo de entradas
+    uint32_t used;              // Número de entradas já retiradas do vetor
+    uint32_t negative;          // Número de entradas negativas em cache
+    uint64_t hits;              // Buscas atendidas pela cache
+    uint64_t misses;            // Buscas que precisaram percorrer o diretório
+    uint64_t rhits;             // Buscas reversas (inode -> pai e nome) atendidas pela cache
+    uint64_t rmisses;           // Buscas reversas que precisaram percorrer o diretório pai
+} fs_dcache_t;
+
+/* --------------- Índice de espaço livre --------------- */
+
+struct fs_free_run // Sequência de blocos livres dentro de um grupo
+{
+    uint32_t start; // Primeiro bloco (relativo ao início do grupo)
+    uint32_t len;   // Número de blocos
+};
+
+struct fs_group_free // Blocos livres de um grupo, montados a partir do bitmap de blocos
+{
+    struct fs_free_run *runs; // Sequências livres em ordem crescente (sem sequências adjacentes)
+    uint32_t count;           // Número de sequências
+    uint32_t cap;             // Capacidade alocada
+    struct fs_free_run *resv; // Janelas de reserva em ordem crescente (livres no bitmap, fora de 'runs')
+    uint32_t resv_count;      // Número de janelas
+    uint32_t resv_cap;        // Capacidade alocada para as janelas
+    uint32_t reserved;        // Total de blocos reservados no grupo
+    uint8_t loaded;           // 1 se as sequências já foram montadas a partir do bitmap
+};
+
+typedef struct // Índice dos blocos livres: resumo por grupo e sequências livres de cada grupo
+{
+    struct fs_group_free *groups; // Sequências livres de cada grupo (montadas sob demanda)
+    uint32_t *tree;               // Árvore de segmentos com o maior número de blocos livres de cada intervalo de grupos
+    uint32_t leaves;              // Número de folhas da árvore (potência de 2 >= número de grupos)
+    uint64_t loads;               // Bitmaps de blocos convertidos em sequências livres
+} fs_freeidx_t;
+
+#endif /* CACHE_H */
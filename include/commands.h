@@ -51,6 +51,10 @@ int cmd_rename(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd);
 int cmd_cp(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd);
 int cmd_mv(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd);
 int cmd_print(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd);
+int cmd_sync(int argc, char **argv, ext2_fs_t *fs, uint32_t *cwd);
+
+/* --------------- Auxiliares compartilhados --------------- */
+void build_perm_string(struct ext2_inode *inode, char out[11]); // Definida em attr.c, usada também pelo ls -l
 
 #define CMD_TABLE_END {NULL, NULL, NULL}
 
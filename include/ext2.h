@@ -16,11 +16,12 @@
  * @date    01/07/2025
  */
 
-#define EXT2_SUPER_MAGIC 0xEF53 // Assinatura do superbloco
-#define EXT2_BLOCK_SIZE 1024    // Bloco fixo: 1 KiB
-#define PTRS_PER_BLOCK 256      // 1024 / 4
-#define EXT2_N_BLOCKS 15        // 12 + 1 + 1 + 1
-#define EXT2_NAME_LEN 255       // Tamanho máximo de nome de arquivo
+#define EXT2_SUPER_MAGIC 0xEF53                                          // Assinatura do superbloco
+#define EXT2_MIN_BLOCK_SIZE 1024                                         // Menor bloco: 1 KiB (s_log_block_size = 0)
+#define EXT2_MAX_BLOCK_SIZE 4096                                         // Maior bloco suportado: 4 KiB (tamanho da página)
+#define EXT2_MAX_PTRS_PER_BLOCK (EXT2_MAX_BLOCK_SIZE / sizeof(uint32_t)) // Ponteiros em um bloco indireto de tamanho máximo
+#define EXT2_N_BLOCKS 15                                                 // 12 + 1 + 1 + 1
+#define EXT2_NAME_LEN 255                                                // Tamanho máximo de nome de arquivo
 
 /* --------------- Valores de modo de arquivo (i_mode) --------------- */
 
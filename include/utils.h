@@ -2,9 +2,12 @@
 #define UTILS_H
 
 #include <stdint.h>
+#include <stdio.h>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "ext2.h"
+#include "cache.h"
 
 /**
  * @file    utils.h
@@ -19,50 +22,237 @@
  * @date    01/07/2025
  */
 
+/* --------------- Modos de abertura --------------- */
+#define FS_OPEN_MMAP 0x1         // Mapeia a imagem inteira em memória (mmap) em vez de usar a cache de blocos
+#define FS_OPEN_URING 0x2        // Usa io_uring para as leituras de blocos em lote
+#define FS_OPEN_RAM 0x4          // Carrega a imagem inteira em memória e a grava de volta no sync/fechamento
+#define FS_OPEN_SYNC_COMMAND 0x8 // Grava as alterações e faz fsync ao fim de cada comando
+#define FS_OPEN_SYNC_STRICT 0x10 // Como FS_OPEN_SYNC_COMMAND, com barreiras que ordenam as escritas
+#define FS_OPEN_WAL 0x20         // Grava as alterações antes no log "<imagem>.wal" (apenas no backend file)
+#define FS_OPEN_FLUSHER 0x40     // Grava os blocos sujos em segundo plano (backend file, modo FS_DURABILITY_NONE, sem log)
+
+/* --------------- Modos de durabilidade --------------- */
+#define FS_DURABILITY_NONE 0    // Alterações em memória até o sync ou o fechamento, sem fsync
+#define FS_DURABILITY_COMMAND 1 // Alterações gravadas e sincronizadas (fsync) ao fim de cada comando
+#define FS_DURABILITY_STRICT 2  // Blocos, inodes e bitmaps sincronizados antes dos descritores e do superbloco
+
+#define FS_URING_ENTRIES 256 // Tamanho da fila de submissão do io_uring (um bloco indireto inteiro)
+#define FS_IOV_MAX 1024      // Máximo de trechos em uma chamada a preadv/pwritev (IOV_MAX do Linux)
+#define FS_READ_GAP_BLOCKS 4 // Maior intervalo entre duas sequências lido (e descartado) para juntá-las em um preadv
+
+#define FS_IO_MAX_DEFAULT (1024 * 1024) // Tamanho máximo padrão de uma leitura ou escrita agrupada
+
+#define FS_PREALLOC_DEFAULT 8 // Blocos reservados por inode se o superbloco não definir s_prealloc_blocks
+
+#define FS_READ_BATCH_BYTES (1024 * 1024) // Maior lote lido de uma vez ao exportar um arquivo
+#define FS_READ_BATCH_RUNS 64             // Máximo de sequências de blocos em um lote
+#define FS_COPY_MIN_BYTES (256 * 1024)    // Menor sequência contígua copiada pelo kernel (copy_file_range) ao exportar
+
+#define FS_READAHEAD_MIN_BYTES (128 * 1024)      // Janela inicial da leitura antecipada de um arquivo
+#define FS_READAHEAD_MAX_BYTES (8 * 1024 * 1024) // Maior janela da leitura antecipada de um arquivo
+
+struct fs_uring;     // Anel do io_uring (definido em uring.c)
+struct fs_io_ops;    // Operações de um backend de E/S (definido abaixo)
+struct fs_block_run; // Sequência de blocos de um arquivo (definido abaixo)
+
 typedef struct
 {
-    int fd;                     // Descritor de arquivo da imagem
-    struct ext2_super_block sb; // Superbloco do sistema de arquivos
-    uint32_t groups_count;      // Número de grupos de blocos
+    int fd;                      // Descritor de arquivo da imagem
+    const struct fs_io_ops *io;  // Backend de E/S escolhido em fs_open
+    void *io_data;               // Estado privado do backend
+    uint8_t *map;                // Imagem inteira em memória (backends mmap e ram; NULL no backend file)
+    size_t map_size;             // Tamanho da imagem em memória em bytes
+    struct fs_uring *uring;      // Anel do io_uring (NULL se não for usado)
+    struct ext2_super_block sb;  // Superbloco do sistema de arquivos
+    int sb_dirty;                // Superbloco alterado ainda não escrito (contadores de livres)
+    int durability;              // Modo de durabilidade (FS_DURABILITY_*)
+    uint32_t txn_depth;          // Aninhamento de transações (0 fora de transação)
+    int wal_fd;                  // Descritor do log de escrita antecipada (-1 se não for usado)
+    uint32_t io_max;             // Tamanho máximo em bytes de uma leitura ou escrita agrupada (preadv/pwritev)
+    uint32_t block_size;         // Tamanho do bloco em bytes (1024 << s_log_block_size)
+    uint32_t ptrs_per_block;     // Ponteiros de bloco em um bloco indireto (block_size / 4)
+    uint32_t groups_count;       // Número de grupos de blocos
+    struct ext2_group_desc *gdt; // Tabela de descritores de grupo carregada em memória
+    uint8_t *gdt_dirty;          // Marca os descritores alterados ainda não escritos
+    fs_bcache_t bcache;          // Cache de blocos (write-back)
+    fs_flusher_t flusher;        // Gravação dos blocos sujos em segundo plano
+    fs_icache_t icache;          // Cache de inodes
+    fs_dcache_t dcache;          // Cache de entradas de diretório
+    fs_freeidx_t freeidx;        // Índice de espaço livre usado na alocação de blocos
+    uint32_t cwd_ino;            // Inode do diretório corrente cujo caminho está em cwd_path
+    char *cwd_path;              // Caminho absoluto do diretório corrente (NULL se precisar ser recalculado)
 } ext2_fs_t;
 
+/* --------------- Backends de E/S --------------- */
+struct fs_io_ops // Operações de E/S sobre a imagem (retornam 0 ou -1)
+{
+    const char *name;                                                                         // Nome do backend
+    int (*open)(ext2_fs_t *fs);                                                               // Prepara o backend (fs->fd já aberto)
+    void (*close)(ext2_fs_t *fs);                                                             // Libera o estado do backend
+    int (*read_block)(ext2_fs_t *fs, uint32_t block, void *buf);                              // Lê um bloco inteiro
+    int (*write_block)(ext2_fs_t *fs, uint32_t block, const void *buf);                       // Escreve um bloco inteiro
+    int (*write_blocks)(ext2_fs_t *fs, uint32_t block, uint8_t *const *bufs, uint32_t count); // Escreve blocos consecutivos de buffers separados (opcional)
+    int (*read_vec)(ext2_fs_t *fs, struct iovec *iov, int iovcnt, off_t off);                 // Lê trechos consecutivos da imagem para buffers separados (opcional)
+    int (*read_range)(ext2_fs_t *fs, void *buf, size_t len, off_t off);                       // Lê um trecho qualquer
+    int (*write_range)(ext2_fs_t *fs, const void *buf, size_t len, off_t off);                // Escreve um trecho qualquer
+    void (*dirty)(ext2_fs_t *fs, uint32_t block);                                             // Bloco alterado via fs_block_ptr (opcional)
+    void (*willneed)(ext2_fs_t *fs, uint32_t block, uint32_t count);                          // Avisa que blocos consecutivos serão lidos em breve (opcional)
+    int (*flush)(ext2_fs_t *fs);                                                              // Grava na imagem o que estiver pendente
+    off_t (*size)(ext2_fs_t *fs);                                                             // Tamanho da imagem em bytes
+};
+
+extern const struct fs_io_ops fs_io_file; // pread/pwrite, com a cache de blocos
+extern const struct fs_io_ops fs_io_mmap; // Imagem mapeada com mmap
+extern const struct fs_io_ops fs_io_ram;  // Imagem carregada inteira em memória
+
+void fs_io_dirty(ext2_fs_t *fs, uint32_t block);
+void fs_io_willneed(ext2_fs_t *fs, uint32_t block, uint32_t count);
+uint32_t fs_io_max_blocks(ext2_fs_t *fs);
+
 /* --------------- Acesso a imagem --------------- */
-ext2_fs_t *fs_open(char *img_path);
+ext2_fs_t *fs_open(char *img_path, int flags);
 void fs_close(ext2_fs_t *fs);
 off_t fs_block_offset(ext2_fs_t *fs, uint32_t block);
+void *fs_block_ptr(ext2_fs_t *fs, uint32_t block);
 int fs_read_block(ext2_fs_t *fs, uint32_t block, void *buf);
 int fs_write_block(ext2_fs_t *fs, uint32_t block, void *buf);
 
+/* --------------- Cache de blocos --------------- */
+int fs_bcache_init(ext2_fs_t *fs, uint32_t capacity);
+void fs_bcache_destroy(ext2_fs_t *fs);
+struct fs_buf *fs_buf_peek(ext2_fs_t *fs, uint32_t block);
+struct fs_buf *fs_buf_get(ext2_fs_t *fs, uint32_t block, int read);
+void fs_buf_dirty(ext2_fs_t *fs, struct fs_buf *b);
+int fs_bcache_flush(ext2_fs_t *fs);
+int fs_bcache_readahead(ext2_fs_t *fs, const uint32_t *blocks, uint32_t count);
+
+/* --------------- Flusher --------------- */
+int fs_flusher_start(ext2_fs_t *fs);
+void fs_flusher_stop(ext2_fs_t *fs);
+void fs_flusher_kick(ext2_fs_t *fs);
+void fs_flusher_wait(ext2_fs_t *fs);
+void fs_lock(ext2_fs_t *fs);
+void fs_unlock(ext2_fs_t *fs);
+uint64_t fs_clock_ms(void);
+
+/* --------------- io_uring --------------- */
+int fs_uring_init(ext2_fs_t *fs, unsigned entries);
+void fs_uring_destroy(ext2_fs_t *fs);
+int fs_uring_read_runs(ext2_fs_t *fs, const struct fs_block_run *runs, uint8_t *const *bufs, uint32_t count);
+
 /* --------------- Descritores de grupo --------------- */
+off_t gd_offset(ext2_fs_t *fs, uint32_t group);
 int fs_read_group_desc(ext2_fs_t *fs, uint32_t group, struct ext2_group_desc *gd);
 int fs_write_group_desc(ext2_fs_t *fs, uint32_t group, struct ext2_group_desc *gd);
+int fs_flush_group_descs(ext2_fs_t *fs);
 
 /* --------------- Inodes --------------- */
 int inode_loc(ext2_fs_t *fs, uint32_t ino, struct ext2_group_desc *gd_out, off_t *off);
 int fs_read_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode);
 int fs_write_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode);
-int fs_alloc_inode(ext2_fs_t *fs, uint16_t mode, uint32_t *out_ino);
+int fs_alloc_inode(ext2_fs_t *fs, uint16_t mode, uint32_t parent, uint32_t *out_ino);
 int fs_free_inode(ext2_fs_t *fs, uint32_t ino);
 void print_entry(struct ext2_dir_entry *e);
 
+/* --------------- Cache de inodes --------------- */
+int fs_icache_init(ext2_fs_t *fs, uint32_t capacity);
+void fs_icache_destroy(ext2_fs_t *fs);
+struct ext2_inode *fs_iget(ext2_fs_t *fs, uint32_t ino);
+void fs_iput(ext2_fs_t *fs, struct ext2_inode *inode);
+void fs_idirty(ext2_fs_t *fs, struct ext2_inode *inode);
+int fs_icache_flush(ext2_fs_t *fs);
+int fs_icache_prefetch(ext2_fs_t *fs, const uint32_t *inos, uint32_t count);
+int fs_inode_extents(ext2_fs_t *fs, struct ext2_inode *inode, const struct fs_extent **ext, uint32_t *count);
+void fs_inode_readahead(ext2_fs_t *fs, struct ext2_inode *inode, uint32_t logical, uint32_t count);
+int fs_inode_alloc_block(ext2_fs_t *fs, uint32_t ino, const struct ext2_inode *inode, uint32_t logical, uint32_t *out_block);
+void fs_prealloc_release(ext2_fs_t *fs, uint32_t ino);
+
+/* --------------- Cache de entradas de diretório --------------- */
+int fs_dcache_init(ext2_fs_t *fs, uint32_t capacity);
+void fs_dcache_destroy(ext2_fs_t *fs);
+int fs_dcache_lookup(ext2_fs_t *fs, uint32_t parent, const char *name, uint32_t *ino);
+void fs_dcache_add(ext2_fs_t *fs, uint32_t parent, const char *name, uint32_t ino);
+void fs_dcache_invalidate(ext2_fs_t *fs, uint32_t parent, uint32_t ino);
+void fs_dcache_purge(ext2_fs_t *fs, uint32_t dir);
+int fs_dcache_reverse(ext2_fs_t *fs, uint32_t ino, uint32_t *parent, const char **name);
+
+/* --------------- Bitmaps --------------- */
+int bitmap_find_clear(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t *out);
+uint32_t bitmap_find_clear_n(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out);
+int bitmap_find_clear_run(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out);
+int bitmap_find_set(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t *out);
+void bitmap_set_run(uint8_t *map, uint32_t start, uint32_t n);
+void bitmap_clear_run(uint8_t *map, uint32_t start, uint32_t n);
+
+/* --------------- Índice de espaço livre --------------- */
+int fs_freeidx_init(ext2_fs_t *fs);
+void fs_freeidx_destroy(ext2_fs_t *fs);
+void fs_freeidx_update(ext2_fs_t *fs, uint32_t group, uint32_t free_blocks);
+int fs_freeidx_find_group(ext2_fs_t *fs, uint32_t start, uint32_t min_free, uint32_t *group);
+int fs_freeidx_find_run(ext2_fs_t *fs, uint32_t group, const uint8_t *bitmap, uint32_t from, uint32_t want, uint32_t *idx, uint32_t *len);
+void fs_freeidx_take(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len);
+void fs_freeidx_put(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len);
+int fs_freeidx_reserve(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len);
+int fs_freeidx_unreserve(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len);
+uint32_t fs_freeidx_skip_reserved(ext2_fs_t *fs, uint32_t group, uint32_t idx);
+uint32_t fs_freeidx_avail(ext2_fs_t *fs, uint32_t group);
+
 /* --------------- Blocos de dados --------------- */
-int fs_alloc_block(ext2_fs_t *fs, uint32_t *out_block);
+uint32_t fs_group_blocks(ext2_fs_t *fs, uint32_t group);
+uint32_t fs_block_goal(ext2_fs_t *fs, uint32_t ino, const struct ext2_inode *inode, uint32_t logical);
+int fs_alloc_block(ext2_fs_t *fs, uint32_t goal, uint32_t *out_block);
+int fs_alloc_blocks(ext2_fs_t *fs, uint32_t goal, uint32_t want, uint32_t *out_block, uint32_t *out_len);
+int fs_reserve_blocks(ext2_fs_t *fs, uint32_t goal, uint32_t want, uint32_t *out_block, uint32_t *out_len);
+int fs_alloc_reserved(ext2_fs_t *fs, uint32_t block);
+void fs_unreserve_blocks(ext2_fs_t *fs, uint32_t block, uint32_t count);
 int fs_free_block(ext2_fs_t *fs, uint32_t block);
+int fs_free_blocks(ext2_fs_t *fs, uint32_t block, uint32_t count);
 int free_inode_blocks(ext2_fs_t *fs, struct ext2_inode *inode);
 
+/* --------------- Mapa de blocos --------------- */
+#define FS_BMAP_META 0x1 // Também reporta os blocos indiretos (com meta = 1)
+
+struct fs_block_run // Sequência de blocos lógicos consecutivos de um arquivo
+{
+    uint32_t logical;  // Primeiro bloco lógico
+    uint32_t physical; // Primeiro bloco físico (0 para buraco)
+    uint32_t len;      // Número de blocos
+    int meta;          // 1 se for um bloco indireto (apenas com FS_BMAP_META)
+};
+
+typedef int (*block_run_cb)(const struct fs_block_run *run, void *user);
+uint32_t fs_file_blocks(ext2_fs_t *fs, const struct ext2_inode *inode);
+int fs_map_blocks(ext2_fs_t *fs, const struct ext2_inode *inode, uint32_t nblocks, int flags, block_run_cb cb, void *user);
+int fs_read_runs(ext2_fs_t *fs, const struct fs_block_run *runs, uint32_t count, void *buf);
+int fs_dump_file(ext2_fs_t *fs, uint32_t ino, FILE *out);
+ssize_t fs_read_file(ext2_fs_t *fs, uint32_t ino, void *buf, size_t len, off_t off);
+
 /* --------------- Diretórios --------------- */
 typedef int (*dir_iter_cb)(struct ext2_dir_entry *entry, void *user);
 int fs_iterate_dir(ext2_fs_t *fs, struct ext2_inode *dir_inode, dir_iter_cb cb, void *user);
 int fs_find_in_dir(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name, uint32_t *out_ino);
+int fs_lookup(ext2_fs_t *fs, uint32_t dir_ino, char *name, uint32_t *out_ino);
 uint16_t rec_len_needed(uint8_t name_len);
 
 /* --------------- Caminhos --------------- */
 int fs_path_resolve(ext2_fs_t *fs, char *path, uint32_t *ino);
 char *fs_get_path(ext2_fs_t *fs, uint32_t dir_ino);
 char *fs_join_path(ext2_fs_t *fs, uint32_t cwd, const char *rel);
+const char *fs_cwd_path(ext2_fs_t *fs, uint32_t cwd);
+int fs_set_cwd(ext2_fs_t *fs, uint32_t ino, const char *path);
+void fs_cwd_invalidate(ext2_fs_t *fs);
 
 /* --------------- Sincronização --------------- */
 int fs_sync_super(ext2_fs_t *fs);
+int fs_sync(ext2_fs_t *fs);
+
+/* --------------- Transações e log --------------- */
+void fs_txn_begin(ext2_fs_t *fs);
+int fs_txn_commit(ext2_fs_t *fs);
+int fs_wal_open(ext2_fs_t *fs, const char *img_path);
+void fs_wal_close(ext2_fs_t *fs);
+int fs_wal_write(ext2_fs_t *fs);
+int fs_wal_clear(ext2_fs_t *fs);
 
 /* --------------- Nomes --------------- */
 int name_exists(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name);
@@ -0,0 +1,489 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    bcache.c
+ *
+ * Cache de blocos com despejo LRU e escrita adiada (write-back).
+ *
+ * Todos os acessos a blocos feitos por fs_read_block/fs_write_block passam por
+ * esta cache. Blocos modificados ficam marcados como sujos e só são escritos na
+ * imagem quando despejados, em fs_bcache_flush (comando sync), em fs_close ou
+ * pelo flusher em segundo plano (flusher.c).
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/**
+ * @brief   Calcula o índice da tabela hash para um bloco.
+ *
+ * @param   bc      Ponteiro para a cache de blocos.
+ * @param   block   Número do bloco.
+ *
+ * @return  Índice da lista na tabela hash.
+ */
+static uint32_t bcache_hash(fs_bcache_t *bc, uint32_t block)
+{
+    return (block * 2654435761u) & bc->hash_mask; // Hash multiplicativo de Knuth
+}
+
+/**
+ * @brief   Remove um buffer da lista LRU.
+ *
+ * @param   bc  Ponteiro para a cache de blocos.
+ * @param   b   Buffer a ser removido.
+ */
+static void lru_unlink(fs_bcache_t *bc, struct fs_buf *b)
+{
+    if (b->prev)
+        b->prev->next = b->next;
+    else
+        bc->lru_head = b->next;
+    if (b->next)
+        b->next->prev = b->prev;
+    else
+        bc->lru_tail = b->prev;
+    b->prev = b->next = NULL;
+}
+
+/**
+ * @brief   Insere um buffer no início da lista LRU (mais recente).
+ *
+ * @param   bc  Ponteiro para a cache de blocos.
+ * @param   b   Buffer a ser inserido.
+ */
+static void lru_push_front(fs_bcache_t *bc, struct fs_buf *b)
+{
+    b->prev = NULL;
+    b->next = bc->lru_head;
+    if (bc->lru_head)
+        bc->lru_head->prev = b;
+    bc->lru_head = b;
+    if (!bc->lru_tail)
+        bc->lru_tail = b;
+}
+
+/**
+ * @brief   Insere um buffer no fim da lista LRU (primeiro a ser reaproveitado).
+ *
+ * @param   bc  Ponteiro para a cache de blocos.
+ * @param   b   Buffer a ser inserido.
+ */
+static void lru_push_back(fs_bcache_t *bc, struct fs_buf *b)
+{
+    b->next = NULL;
+    b->prev = bc->lru_tail;
+    if (bc->lru_tail)
+        bc->lru_tail->next = b;
+    bc->lru_tail = b;
+    if (!bc->lru_head)
+        bc->lru_head = b;
+}
+
+/**
+ * @brief   Remove um buffer da tabela hash.
+ *
+ * @param   bc  Ponteiro para a cache de blocos.
+ * @param   b   Buffer a ser removido.
+ */
+static void hash_unlink(fs_bcache_t *bc, struct fs_buf *b)
+{
+    struct fs_buf **pp = &bc->hash[bcache_hash(bc, b->block)];
+    while (*pp && *pp != b)
+        pp = &(*pp)->hnext;
+    if (*pp)
+        *pp = b->hnext;
+    b->hnext = NULL;
+}
+
+/**
+ * @brief   Escreve o conteúdo de um buffer sujo na imagem.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   b   Buffer a ser escrito.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int bcache_writeback(ext2_fs_t *fs, struct fs_buf *b)
+{
+    fs_flusher_wait(fs); // Uma cópia antiga do bloco pode estar sendo gravada pelo flusher
+    if (fs->io->write_block(fs, b->block, b->data) < 0)
+        return -1;
+    b->dirty = 0;
+    fs->bcache.dirty--;
+    fs->bcache.writebacks++;
+    return 0;
+}
+
+/**
+ * @brief   Inicializa a cache de blocos do sistema de arquivos.
+ *
+ * @param   fs        Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   capacity  Número máximo de blocos mantidos em memória.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_bcache_init(ext2_fs_t *fs, uint32_t capacity)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    memset(bc, 0, sizeof(*bc));
+
+    uint32_t buckets = 1;
+    while (buckets < capacity) // Tabela hash com tamanho potência de 2
+        buckets <<= 1;
+
+    bc->bufs = calloc(capacity, sizeof(struct fs_buf));
+    bc->data = malloc((size_t)capacity * fs->block_size);
+    bc->hash = calloc(buckets, sizeof(struct fs_buf *));
+    if (!bc->bufs || !bc->data || !bc->hash)
+    {
+        fs_bcache_destroy(fs);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < capacity; ++i)
+        bc->bufs[i].data = bc->data + (size_t)i * fs->block_size;
+    bc->hash_mask = buckets - 1;
+    bc->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief   Libera a memória da cache de blocos (sem escrever os blocos sujos).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_bcache_destroy(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    free(bc->bufs);
+    free(bc->data);
+    free(bc->hash);
+    memset(bc, 0, sizeof(*bc));
+}
+
+/**
+ * @brief   Procura um bloco na cache.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   block   Número do bloco procurado.
+ *
+ * @return  Ponteiro para o buffer ou NULL se o bloco não estiver em cache.
+ */
+static struct fs_buf *bcache_lookup(ext2_fs_t *fs, uint32_t block)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    for (struct fs_buf *b = bc->hash[bcache_hash(bc, block)]; b; b = b->hnext)
+        if (b->block == block)
+            return b;
+    return NULL;
+}
+
+/**
+ * @brief   Procura um bloco na cache sem carregá-lo nem alterar a ordem LRU.
+ *
+ * Usada por leituras em lote que acessam a imagem diretamente, para não
+ * ignorar blocos sujos mantidos em memória.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   block   Número do bloco.
+ *
+ * @return  Ponteiro para o buffer ou NULL se o bloco não estiver em cache.
+ */
+struct fs_buf *fs_buf_peek(ext2_fs_t *fs, uint32_t block)
+{
+    return bcache_lookup(fs, block);
+}
+
+/**
+ * @brief   Dobra a capacidade da cache de blocos, mantendo os buffers em uso.
+ *
+ * Os vetores de buffers e de dados são realocados e os ponteiros internos
+ * (lista LRU e tabela hash) são corrigidos. Ponteiros para buffers obtidos
+ * antes da chamada deixam de valer.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int bcache_grow(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    uint32_t capacity = bc->capacity * 2;
+    uint32_t buckets = bc->hash_mask + 1;
+    while (buckets < capacity)
+        buckets <<= 1;
+
+    struct fs_buf *bufs = calloc(capacity, sizeof(struct fs_buf));
+    uint8_t *data = malloc((size_t)capacity * fs->block_size);
+    struct fs_buf **hash = calloc(buckets, sizeof(struct fs_buf *));
+    if (!bufs || !data || !hash)
+    {
+        free(bufs);
+        free(data);
+        free(hash);
+        return -1;
+    }
+
+    struct fs_buf *old_bufs = bc->bufs;
+    struct fs_buf **old_hash = bc->hash;
+    uint32_t old_mask = bc->hash_mask;
+#define RELOC(p) ((p) ? bufs + ((p) - old_bufs) : NULL) // Mesmo buffer no vetor novo
+    memcpy(bufs, old_bufs, bc->used * sizeof(struct fs_buf));
+    memcpy(data, bc->data, (size_t)bc->used * fs->block_size);
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+        bufs[i].data = data + (size_t)i * fs->block_size;
+        bufs[i].prev = RELOC(bufs[i].prev);
+        bufs[i].next = RELOC(bufs[i].next);
+        bufs[i].hnext = NULL;
+    }
+    bc->lru_head = RELOC(bc->lru_head);
+    bc->lru_tail = RELOC(bc->lru_tail);
+    free(bc->data);
+    bc->bufs = bufs;
+    bc->data = data;
+    bc->hash = hash;
+    bc->hash_mask = buckets - 1;
+    bc->capacity = capacity;
+
+    for (uint32_t h = 0; h <= old_mask; ++h) // Refaz a tabela hash só com os buffers que estavam nela
+        for (struct fs_buf *b = old_hash[h]; b; b = b->hnext)
+        {
+            struct fs_buf *nb = RELOC(b);
+            uint32_t nh = bcache_hash(bc, nb->block);
+            nb->hnext = hash[nh];
+            hash[nh] = nb;
+        }
+#undef RELOC
+    free(old_bufs);
+    free(old_hash);
+    return 0;
+}
+
+/**
+ * @brief   Obtém o buffer de um bloco, carregando-o da imagem se necessário.
+ *
+ * Em caso de falta, reaproveita um buffer livre ou despeja o buffer usado há
+ * mais tempo (escrevendo-o na imagem antes, se estiver sujo). Com log aberto,
+ * nenhum bloco sujo pode chegar à imagem antes de fs_sync gravar o log (nem
+ * durante a própria confirmação, quando fs_icache_flush ainda lê tabelas de
+ * inodes): despeja o buffer limpo usado há mais tempo e, se todos estiverem sujos,
+ * dobra a capacidade da cache (bcache_grow). O ponteiro retornado é válido
+ * até a próxima chamada que acesse a cache.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   block   Número do bloco.
+ * @param   read    Se 0, o conteúdo não é lido (o chamador vai sobrescrever o bloco inteiro).
+ *
+ * @return  Ponteiro para o buffer ou NULL em caso de erro.
+ */
+struct fs_buf *fs_buf_get(ext2_fs_t *fs, uint32_t block, int read)
+{
+    fs_bcache_t *bc = &fs->bcache;
+
+    struct fs_buf *b = bcache_lookup(fs, block);
+    if (b) // Acerto: move para o início da LRU
+    {
+        bc->hits++;
+        lru_unlink(bc, b);
+        lru_push_front(bc, b);
+        return b;
+    }
+
+    bc->misses++;
+    int logged = fs->wal_fd >= 0; // Com log: blocos sujos só vão à imagem depois do log (em fs_sync)
+    if (logged && bc->used == bc->capacity && bc->dirty == bc->used && bcache_grow(fs) < 0)
+        return NULL;
+    if (bc->used < bc->capacity) // Ainda há buffers livres
+        b = &bc->bufs[bc->used++];
+    else // Despeja o buffer menos recentemente usado
+    {
+        b = bc->lru_tail;
+        while (logged && b->dirty) // Há pelo menos um buffer limpo
+            b = b->prev;
+        if (b->dirty && bcache_writeback(fs, b) < 0)
+            return NULL;
+        lru_unlink(bc, b);
+        hash_unlink(bc, b);
+    }
+
+    b->block = block;
+    b->dirty = 0;
+    if (read && fs->io->read_block(fs, block, b->data) < 0)
+    {
+        lru_push_back(bc, b); // Buffer volta ao fim da LRU, fora da tabela hash
+        return NULL;
+    }
+
+    uint32_t h = bcache_hash(bc, block);
+    b->hnext = bc->hash[h];
+    bc->hash[h] = b;
+    lru_push_front(bc, b);
+    return b;
+}
+
+/**
+ * @brief   Marca um buffer como sujo (modificado em memória).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   b   Buffer modificado.
+ */
+void fs_buf_dirty(ext2_fs_t *fs, struct fs_buf *b)
+{
+    b->gen++; // Uma cópia gravada pelo flusher antes desta alteração não limpa o buffer
+    if (!b->dirty)
+    {
+        b->dirty = 1;
+        b->dirty_since = fs_clock_ms();
+        fs->bcache.dirty++;
+        fs_flusher_kick(fs);
+    }
+}
+
+/**
+ * @brief   Compara dois buffers pelo número do bloco (para qsort).
+ */
+static int buf_cmp(const void *a, const void *b)
+{
+    uint32_t x = (*(struct fs_buf *const *)a)->block;
+    uint32_t y = (*(struct fs_buf *const *)b)->block;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief   Escreve na imagem todos os blocos sujos da cache.
+ *
+ * Os blocos são escritos em ordem crescente de número para favorecer
+ * o acesso sequencial à imagem. Blocos sujos consecutivos são escritos com
+ * uma única chamada, de até fs->io_max bytes, se o backend oferecer
+ * write_blocks (pwritev).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_bcache_flush(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    fs_flusher_wait(fs); // Espera a rodada em andamento do flusher
+    if (bc->dirty == 0)
+        return 0;
+
+    struct fs_buf **list = malloc(bc->dirty * sizeof(*list));
+    if (!list)
+        return -1;
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < bc->used; ++i) // Coleta os buffers sujos
+        if (bc->bufs[i].dirty)
+            list[n++] = &bc->bufs[i];
+    qsort(list, n, sizeof(*list), buf_cmp);
+
+    int ret = 0;
+    uint8_t *bufs[FS_IOV_MAX];
+    uint32_t max = fs_io_max_blocks(fs);
+    uint32_t i = 0;
+    while (i < n)
+    {
+        uint32_t run = 1; // Blocos consecutivos a partir de list[i]
+        while (fs->io->write_blocks && i + run < n && run < max && list[i + run]->block == list[i]->block + run)
+            run++;
+        if (run == 1)
+        {
+            if (bcache_writeback(fs, list[i]) < 0)
+                ret = -1;
+            i++;
+            continue;
+        }
+
+        for (uint32_t k = 0; k < run; ++k)
+            bufs[k] = list[i + k]->data;
+        if (fs->io->write_blocks(fs, list[i]->block, bufs, run) < 0)
+            ret = -1;
+        else
+            for (uint32_t k = 0; k < run; ++k) // Blocos gravados: deixam de ser sujos
+            {
+                list[i + k]->dirty = 0;
+                fs->bcache.dirty--;
+                fs->bcache.writebacks++;
+            }
+        i += run;
+    }
+
+    free(list);
+    return ret;
+}
+
+/**
+ * @brief   Carrega na cache, de uma só vez, blocos que serão usados em seguida.
+ *
+ * Os blocos que ainda não estão em cache são lidos da imagem com uma leitura
+ * por sequência de blocos consecutivos e guardados na cache como limpos. São
+ * carregados no máximo metade da capacidade da cache, para que a leitura
+ * antecipada não despeje os próprios blocos. Sem a cache (imagem em memória),
+ * não faz nada.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   blocks  Números dos blocos em ordem crescente, sem repetições.
+ * @param   count   Número de blocos.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_bcache_readahead(ext2_fs_t *fs, const uint32_t *blocks, uint32_t count)
+{
+    if (fs->map)
+        return 0;
+    if (count > fs->bcache.capacity / 2)
+        count = fs->bcache.capacity / 2;
+
+    uint8_t *tmp = NULL;
+    uint32_t tmp_len = 0;
+    uint32_t i = 0;
+    while (i < count)
+    {
+        if (bcache_lookup(fs, blocks[i])) // Já está em cache
+        {
+            i++;
+            continue;
+        }
+
+        uint32_t run = 1; // Blocos consecutivos fora da cache
+        while (i + run < count && blocks[i + run] == blocks[i] + run && !bcache_lookup(fs, blocks[i + run]))
+            run++;
+        if (run > tmp_len)
+        {
+            uint8_t *p = realloc(tmp, (size_t)run * fs->block_size);
+            if (!p)
+                break;
+            tmp = p;
+            tmp_len = run;
+        }
+        if (fs->io->read_range(fs, tmp, (size_t)run * fs->block_size, fs_block_offset(fs, blocks[i])) < 0)
+        {
+            free(tmp);
+            return -1;
+        }
+        for (uint32_t k = 0; k < run; ++k) // Guarda os blocos lidos na cache
+        {
+            struct fs_buf *b = fs_buf_get(fs, blocks[i + k], 0);
+            if (!b)
+            {
+                free(tmp);
+                return -1;
+            }
+            memcpy(b->data, tmp + (size_t)k * fs->block_size, fs->block_size);
+        }
+        i += run;
+    }
+    free(tmp);
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "utils.h"
+
+/**
+ * @file    bitmap.c
+ *
+ * Busca de bits livres nos bitmaps de blocos e de inodes.
+ *
+ * Os bitmaps do EXT2 guardam o bit i no bit (i % 8) do byte (i / 8), o que
+ * corresponde a palavras de 64 bits em little-endian. A busca percorre uma
+ * palavra por vez e encontra o primeiro bit livre com count-trailing-zeros;
+ * com SSE2, trechos de 128 bits totalmente ocupados são pulados de uma vez.
+ * Bits além do tamanho do bitmap são tratados como ocupados.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define WORD_BITS 64
+#define WORD_FULL UINT64_MAX
+
+/**
+ * @brief   Lê a palavra 'w' do bitmap, marcando como ocupados os bits além de 'nbits'.
+ *
+ * Só são lidos os bytes que pertencem ao bitmap, então o buffer não precisa
+ * ter tamanho múltiplo de 8 bytes.
+ */
+static uint64_t load_word(const uint8_t *map, uint32_t nbits, uint32_t w)
+{
+    uint32_t bits = nbits - w * WORD_BITS;
+    if (bits > WORD_BITS)
+        bits = WORD_BITS;
+
+    uint64_t v = 0;
+    memcpy(&v, map + (size_t)w * 8, (bits + 7) / 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    if (bits < WORD_BITS)
+        v |= WORD_FULL << bits;
+    return v;
+}
+
+/**
+ * @brief   Pula as palavras totalmente ocupadas a partir da palavra 'w'.
+ *
+ * @return  Índice da primeira palavra que pode ter um bit livre (ou o número de palavras).
+ */
+static uint32_t skip_full(const uint8_t *map, uint32_t nbits, uint32_t w)
+{
+    uint32_t nwords = (nbits + WORD_BITS - 1) / WORD_BITS;
+#if defined(__SSE2__)
+    const __m128i full = _mm_set1_epi8((char)0xff);
+    while ((w + 2) * WORD_BITS <= nbits) // Dois words inteiros dentro do bitmap
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(map + (size_t)w * 8));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, full)) != 0xffff)
+            break;
+        w += 2;
+    }
+#endif
+    while (w < nwords && load_word(map, nbits, w) == WORD_FULL)
+        w++;
+    return w;
+}
+
+/**
+ * @brief   Procura o primeiro bit livre (0) de um bitmap a partir de uma posição.
+ *
+ * @param   map    Bitmap.
+ * @param   nbits  Número de bits válidos no bitmap.
+ * @param   start  Primeiro bit a considerar.
+ * @param   out    Recebe o índice do bit livre encontrado.
+ *
+ * @return  Retorna 0 se um bit livre foi encontrado ou -1 caso contrário.
+ */
+int bitmap_find_clear(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t *out)
+{
+    if (start >= nbits)
+        return -1;
+
+    uint32_t nwords = (nbits + WORD_BITS - 1) / WORD_BITS;
+    uint32_t w = start / WORD_BITS;
+    uint64_t v = load_word(map, nbits, w) | ((1ULL << (start % WORD_BITS)) - 1); // Bits antes de 'start' não contam
+    while (v == WORD_FULL)
+    {
+        w = skip_full(map, nbits, w + 1);
+        if (w >= nwords)
+            return -1;
+        v = load_word(map, nbits, w);
+    }
+    *out = w * WORD_BITS + (uint32_t)__builtin_ctzll(~v);
+    return 0;
+}
+
+/**
+ * @brief   Procura até 'n' bits livres de um bitmap a partir de uma posição.
+ *
+ * Os bits não precisam ser consecutivos; são retornados em ordem crescente.
+ *
+ * @param   map    Bitmap.
+ * @param   nbits  Número de bits válidos no bitmap.
+ * @param   start  Primeiro bit a considerar.
+ * @param   n      Número máximo de bits a encontrar.
+ * @param   out    Vetor com espaço para 'n' índices.
+ *
+ * @return  Número de bits livres encontrados (menor que 'n' se o bitmap acabar antes).
+ */
+uint32_t bitmap_find_clear_n(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out)
+{
+    if (start >= nbits || !n)
+        return 0;
+
+    uint32_t nwords = (nbits + WORD_BITS - 1) / WORD_BITS;
+    uint32_t found = 0;
+    uint32_t w = start / WORD_BITS;
+    uint64_t v = load_word(map, nbits, w) | ((1ULL << (start % WORD_BITS)) - 1);
+    for (;;)
+    {
+        uint64_t clear = ~v;
+        while (clear && found < n) // Um bit livre por iteração, do menor para o maior
+        {
+            out[found++] = w * WORD_BITS + (uint32_t)__builtin_ctzll(clear);
+            clear &= clear - 1;
+        }
+        if (found == n)
+            return found;
+        w = skip_full(map, nbits, w + 1);
+        if (w >= nwords)
+            return found;
+        v = load_word(map, nbits, w);
+    }
+}
+
+/**
+ * @brief   Procura a primeira sequência de 'n' bits livres consecutivos a partir de uma posição.
+ *
+ * @param   map    Bitmap.
+ * @param   nbits  Número de bits válidos no bitmap.
+ * @param   start  Primeiro bit a considerar.
+ * @param   n      Tamanho da sequência procurada.
+ * @param   out    Recebe o índice do primeiro bit da sequência.
+ *
+ * @return  Retorna 0 se a sequência foi encontrada ou -1 caso contrário.
+ */
+int bitmap_find_clear_run(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out)
+{
+    if (!n)
+        return -1;
+    if (n == 1)
+        return bitmap_find_clear(map, nbits, start, out);
+    if (start >= nbits || n > nbits - start)
+        return -1;
+
+    uint32_t nwords = (nbits + WORD_BITS - 1) / WORD_BITS;
+    uint32_t run_start = 0, run_len = 0; // Sequência livre em andamento
+    uint32_t w = start / WORD_BITS;
+    uint64_t v = load_word(map, nbits, w) | ((1ULL << (start % WORD_BITS)) - 1);
+    for (;;)
+    {
+        if (v == WORD_FULL) // Palavra toda ocupada: interrompe a sequência e pula as seguintes
+        {
+            run_len = 0;
+            w = skip_full(map, nbits, w + 1);
+        }
+        else if (v == 0) // Palavra toda livre: estende a sequência
+        {
+            if (!run_len)
+                run_start = w * WORD_BITS;
+            run_len += WORD_BITS;
+            if (run_len >= n)
+            {
+                *out = run_start;
+                return 0;
+            }
+            w++;
+        }
+        else // Percorre os trechos livres e ocupados da palavra
+        {
+            uint32_t bit = 0;
+            while (bit < WORD_BITS)
+            {
+                uint64_t rest = v >> bit; // Bit 0 é a posição atual
+                if (bit)
+                    rest |= WORD_FULL << (WORD_BITS - bit); // Posições após o fim da palavra contam como ocupadas
+                if (rest == WORD_FULL)                      // O resto da palavra está ocupado
+                {
+                    run_len = 0;
+                    break;
+                }
+                if (rest & 1) // Trecho ocupado
+                {
+                    run_len = 0;
+                    bit += (uint32_t)__builtin_ctzll(~rest);
+                    continue;
+                }
+                uint32_t len = (uint32_t)__builtin_ctzll(rest); // Trecho livre
+                if (!run_len)
+                    run_start = w * WORD_BITS + bit;
+                run_len += len;
+                if (run_len >= n)
+                {
+                    *out = run_start;
+                    return 0;
+                }
+                bit += len;
+            }
+            w++;
+        }
+        if (w >= nwords)
+            return -1;
+        v = load_word(map, nbits, w);
+    }
+}
+
+/**
+ * @brief   Procura o primeiro bit ocupado (1) de um bitmap a partir de uma posição.
+ *
+ * @param   map    Bitmap.
+ * @param   nbits  Número de bits válidos no bitmap.
+ * @param   start  Primeiro bit a considerar.
+ * @param   out    Recebe o índice do bit ocupado encontrado.
+ *
+ * @return  Retorna 0 se um bit ocupado foi encontrado ou -1 caso contrário.
+ */
+int bitmap_find_set(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t *out)
+{
+    if (start >= nbits)
+        return -1;
+
+    uint32_t nwords = (nbits + WORD_BITS - 1) / WORD_BITS;
+    uint32_t w = start / WORD_BITS;
+    uint64_t v = load_word(map, nbits, w) & ~((1ULL << (start % WORD_BITS)) - 1); // Bits antes de 'start' não contam
+    while (!v)
+    {
+        if (++w >= nwords)
+            return -1;
+        v = load_word(map, nbits, w);
+    }
+    uint32_t bit = w * WORD_BITS + (uint32_t)__builtin_ctzll(v);
+    if (bit >= nbits) // Bits além do bitmap não são bits ocupados de verdade
+        return -1;
+    *out = bit;
+    return 0;
+}
+
+/**
+ * @brief   Marca como ocupados 'n' bits consecutivos de um bitmap.
+ *
+ * @param   map    Bitmap.
+ * @param   start  Primeiro bit.
+ * @param   n      Número de bits.
+ */
+void bitmap_set_run(uint8_t *map, uint32_t start, uint32_t n)
+{
+    for (; n && (start & 7); ++start, --n) // Bits até o início de um byte
+        map[BIT_BYTE(start)] |= BIT_MASK(start);
+    memset(map + BIT_BYTE(start), 0xff, n / 8); // Bytes inteiros
+    start += n & ~7u;
+    for (n &= 7; n; ++start, --n) // Bits restantes
+        map[BIT_BYTE(start)] |= BIT_MASK(start);
+}
+
+/**
+ * @brief   Marca como livres 'n' bits consecutivos de um bitmap.
+ *
+ * @param   map    Bitmap.
+ * @param   start  Primeiro bit.
+ * @param   n      Número de bits.
+ */
+void bitmap_clear_run(uint8_t *map, uint32_t start, uint32_t n)
+{
+    for (; n && (start & 7); ++start, --n) // Bits até o início de um byte
+        map[BIT_BYTE(start)] &= (uint8_t)~BIT_MASK(start);
+    memset(map + BIT_BYTE(start), 0, n / 8); // Bytes inteiros
+    start += n & ~7u;
+    for (n &= 7; n; ++start, --n) // Bits restantes
+        map[BIT_BYTE(start)] &= (uint8_t)~BIT_MASK(start);
+}
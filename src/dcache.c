@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    dcache.c
+ *
+ * Cache de entradas de diretório, indexada por (inode do diretório pai, nome).
+ *
+ * Cada entrada associa um nome dentro de um diretório ao inode correspondente.
+ * Entradas negativas (inode 0) registram nomes que não existem, evitando
+ * percorrer novamente o diretório em buscas que falham. Uma segunda tabela
+ * hash indexa as entradas positivas pelo inode, permitindo obter o pai e o
+ * nome de um inode sem ler o disco (usada para montar caminhos). Os comandos
+ * que alteram diretórios (touch, mkdir, rm, rmdir e rename) mantêm a cache coerente.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/**
+ * @brief   Calcula o índice da tabela hash para um par (pai, nome).
+ *
+ * @param   dc        Ponteiro para a cache de entradas de diretório.
+ * @param   parent    Inode do diretório pai.
+ * @param   name      Nome procurado.
+ * @param   name_len  Comprimento do nome.
+ *
+ * @return  Índice da lista na tabela hash.
+ */
+static uint32_t dcache_hash(fs_dcache_t *dc, uint32_t parent, const char *name, size_t name_len)
+{
+    uint32_t h = 2166136261u ^ parent; // FNV-1a iniciado com o inode do pai
+    for (size_t i = 0; i < name_len; ++i)
+    {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 16)) & dc->hash_mask;
+}
+
+/**
+ * @brief   Calcula o índice da tabela reversa para um inode.
+ *
+ * @param   dc   Ponteiro para a cache de entradas de diretório.
+ * @param   ino  Número do inode.
+ *
+ * @return  Índice da lista na tabela reversa.
+ */
+static uint32_t dcache_rhash(fs_dcache_t *dc, uint32_t ino)
+{
+    return (ino * 2654435761u) & dc->hash_mask; // Hash multiplicativo de Knuth
+}
+
+/**
+ * @brief   Indica se uma entrada deve ser indexada na tabela reversa.
+ *
+ * Apenas entradas positivas com nomes reais ("." e ".." não) identificam o pai e o nome de um inode.
+ */
+static int dcache_is_link(struct fs_dentry *d)
+{
+    if (d->ino == 0) // Entrada negativa
+        return 0;
+    return !(d->name[0] == '.' && (d->name_len == 1 || (d->name_len == 2 && d->name[1] == '.')));
+}
+
+/**
+ * @brief   Insere uma entrada na tabela reversa, se for o caso.
+ */
+static void rhash_link(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    if (!dcache_is_link(d))
+        return;
+    uint32_t h = dcache_rhash(dc, d->ino);
+    d->rhnext = dc->rhash[h];
+    dc->rhash[h] = d;
+}
+
+/**
+ * @brief   Remove uma entrada da tabela reversa, se estiver nela.
+ */
+static void rhash_unlink(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    if (!dcache_is_link(d))
+        return;
+    struct fs_dentry **pp = &dc->rhash[dcache_rhash(dc, d->ino)];
+    while (*pp && *pp != d)
+        pp = &(*pp)->rhnext;
+    if (*pp)
+        *pp = d->rhnext;
+    d->rhnext = NULL;
+}
+
+/**
+ * @brief   Remove uma entrada da lista LRU.
+ */
+static void lru_unlink(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    if (d->prev)
+        d->prev->next = d->next;
+    else
+        dc->lru_head = d->next;
+    if (d->next)
+        d->next->prev = d->prev;
+    else
+        dc->lru_tail = d->prev;
+    d->prev = d->next = NULL;
+}
+
+/**
+ * @brief   Insere uma entrada no início da lista LRU (mais recente).
+ */
+static void lru_push_front(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    d->prev = NULL;
+    d->next = dc->lru_head;
+    if (dc->lru_head)
+        dc->lru_head->prev = d;
+    dc->lru_head = d;
+    if (!dc->lru_tail)
+        dc->lru_tail = d;
+}
+
+/**
+ * @brief   Remove uma entrada da tabela hash.
+ */
+static void hash_unlink(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    struct fs_dentry **pp = &dc->hash[dcache_hash(dc, d->parent, d->name, d->name_len)];
+    while (*pp && *pp != d)
+        pp = &(*pp)->hnext;
+    if (*pp)
+        *pp = d->hnext;
+    d->hnext = NULL;
+}
+
+/**
+ * @brief   Procura a entrada de um par (pai, nome) na tabela hash.
+ *
+ * @return  Ponteiro para a entrada ou NULL se o par não estiver em cache.
+ */
+static struct fs_dentry *dcache_find(fs_dcache_t *dc, uint32_t parent, const char *name, size_t name_len)
+{
+    struct fs_dentry *d = dc->hash[dcache_hash(dc, parent, name, name_len)];
+    for (; d; d = d->hnext)
+        if (d->parent == parent && d->name_len == name_len && memcmp(d->name, name, name_len) == 0)
+            return d;
+    return NULL;
+}
+
+/**
+ * @brief   Retira uma entrada da cache e a coloca na lista de entradas livres.
+ *
+ * @param   dc  Ponteiro para a cache de entradas de diretório.
+ * @param   d   Entrada a ser descartada.
+ */
+static void dcache_drop(fs_dcache_t *dc, struct fs_dentry *d)
+{
+    if (d->ino == 0)
+        dc->negative--;
+    rhash_unlink(dc, d);
+    hash_unlink(dc, d);
+    lru_unlink(dc, d);
+    d->next = dc->free;
+    dc->free = d;
+}
+
+/**
+ * @brief   Inicializa a cache de entradas de diretório.
+ *
+ * @param   fs        Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   capacity  Número máximo de entradas mantidas em memória.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_dcache_init(ext2_fs_t *fs, uint32_t capacity)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    memset(dc, 0, sizeof(*dc));
+
+    uint32_t buckets = 1;
+    while (buckets < capacity) // Tabela hash com tamanho potência de 2
+        buckets <<= 1;
+
+    dc->ents = calloc(capacity, sizeof(struct fs_dentry));
+    dc->hash = calloc(buckets, sizeof(struct fs_dentry *));
+    dc->rhash = calloc(buckets, sizeof(struct fs_dentry *));
+    if (!dc->ents || !dc->hash || !dc->rhash)
+    {
+        fs_dcache_destroy(fs);
+        return -1;
+    }
+    dc->hash_mask = buckets - 1;
+    dc->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief   Libera a memória da cache de entradas de diretório.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_dcache_destroy(ext2_fs_t *fs)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    free(dc->ents);
+    free(dc->hash);
+    free(dc->rhash);
+    memset(dc, 0, sizeof(*dc));
+}
+
+/**
+ * @brief   Procura um nome de um diretório na cache.
+ *
+ * Em caso de acerto, nenhum acesso ao disco é feito. Um acerto em entrada
+ * negativa retorna 0 com *ino igual a 0 (o nome não existe).
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   parent  Inode do diretório pai.
+ * @param   name    Nome procurado.
+ * @param   ino     Ponteiro onde o inode encontrado será armazenado.
+ *
+ * @return  Retorna 0 em caso de acerto ou -1 se o nome não estiver em cache.
+ */
+int fs_dcache_lookup(ext2_fs_t *fs, uint32_t parent, const char *name, uint32_t *ino)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    size_t name_len = strlen(name);
+    struct fs_dentry *d = name_len <= EXT2_NAME_LEN ? dcache_find(dc, parent, name, name_len) : NULL;
+    if (!d)
+    {
+        dc->misses++;
+        return -1;
+    }
+
+    dc->hits++;
+    lru_unlink(dc, d); // Acerto: move para o início da LRU
+    lru_push_front(dc, d);
+    *ino = d->ino;
+    return 0;
+}
+
+/**
+ * @brief   Registra na cache o inode associado a um nome de um diretório.
+ *
+ * Se o par já estiver em cache, a entrada é atualizada. Com ino igual a 0 é
+ * criada uma entrada negativa; "." e ".." nunca recebem entradas negativas.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   parent  Inode do diretório pai.
+ * @param   name    Nome da entrada.
+ * @param   ino     Inode do nome, ou 0 se o nome não existir.
+ */
+void fs_dcache_add(ext2_fs_t *fs, uint32_t parent, const char *name, uint32_t ino)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    size_t name_len = strlen(name);
+    if (dc->capacity == 0 || name_len == 0 || name_len > EXT2_NAME_LEN)
+        return;
+    if (ino == 0 && (strcmp(name, ".") == 0 || strcmp(name, "..") == 0))
+        return;
+
+    struct fs_dentry *d = dcache_find(dc, parent, name, name_len);
+    if (d) // Já está em cache: atualiza o inode
+    {
+        dc->negative += (ino == 0) - (d->ino == 0);
+        rhash_unlink(dc, d);
+        d->ino = ino;
+        rhash_link(dc, d);
+        lru_unlink(dc, d);
+        lru_push_front(dc, d);
+        return;
+    }
+
+    if (!dc->free && dc->used == dc->capacity) // Cache cheia: despeja a entrada usada há mais tempo
+        dcache_drop(dc, dc->lru_tail);
+
+    if (dc->free) // Reaproveita uma entrada descartada
+    {
+        d = dc->free;
+        dc->free = d->next;
+    }
+    else // Ainda há entradas livres no vetor
+        d = &dc->ents[dc->used++];
+
+    d->parent = parent;
+    d->ino = ino;
+    d->name_len = (uint8_t)name_len;
+    memcpy(d->name, name, name_len);
+    d->name[name_len] = '\0';
+    if (ino == 0)
+        dc->negative++;
+
+    uint32_t h = dcache_hash(dc, parent, name, name_len);
+    d->hnext = dc->hash[h];
+    dc->hash[h] = d;
+    rhash_link(dc, d);
+    lru_push_front(dc, d);
+}
+
+/**
+ * @brief   Obtém da cache o diretório pai e o nome de um inode.
+ *
+ * O nome retornado aponta para a própria entrada da cache e deve ser copiado
+ * antes de qualquer outra operação sobre a cache.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino     Número do inode.
+ * @param   parent  Ponteiro onde o inode do diretório pai será armazenado.
+ * @param   name    Ponteiro onde o nome do inode será armazenado.
+ *
+ * @return  Retorna 0 em caso de acerto ou -1 se o inode não estiver em cache.
+ */
+int fs_dcache_reverse(ext2_fs_t *fs, uint32_t ino, uint32_t *parent, const char **name)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    struct fs_dentry *d = dc->rhash[dcache_rhash(dc, ino)];
+    while (d && d->ino != ino)
+        d = d->rhnext;
+    if (!d)
+    {
+        dc->rmisses++;
+        return -1;
+    }
+
+    dc->rhits++;
+    lru_unlink(dc, d); // Acerto: move para o início da LRU
+    lru_push_front(dc, d);
+    *parent = d->parent;
+    *name = d->name;
+    return 0;
+}
+
+/**
+ * @brief   Descarta as entradas de um diretório que apontam para um inode.
+ *
+ * Usada quando uma entrada é removida ou renomeada, já que os comandos
+ * localizam a entrada alterada pelo número do inode.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   parent  Inode do diretório pai.
+ * @param   ino     Inode cujas entradas serão descartadas.
+ */
+void fs_dcache_invalidate(ext2_fs_t *fs, uint32_t parent, uint32_t ino)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    struct fs_dentry *d = dc->lru_head;
+    while (d)
+    {
+        struct fs_dentry *next = d->next;
+        if (d->parent == parent && d->ino == ino)
+            dcache_drop(dc, d);
+        d = next;
+    }
+}
+
+/**
+ * @brief   Descarta todas as entradas relacionadas a um diretório removido.
+ *
+ * Remove as entradas contidas no diretório e as que apontam para ele,
+ * pois o número do inode pode ser reutilizado por outro arquivo.
+ *
+ * @param   fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   dir  Inode do diretório removido.
+ */
+void fs_dcache_purge(ext2_fs_t *fs, uint32_t dir)
+{
+    fs_dcache_t *dc = &fs->dcache;
+    struct fs_dentry *d = dc->lru_head;
+    while (d)
+    {
+        struct fs_dentry *next = d->next;
+        if (d->parent == dir || d->ino == dir)
+            dcache_drop(dc, d);
+        d = next;
+    }
+}
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils.h"
+
+/**
+ * @file    flusher.c
+ *
+ * Gravação dos blocos sujos da cache de blocos em segundo plano.
+ *
+ * Uma thread acorda a cada FLUSHER_TICK_MS (ou quando a cache passa de
+ * FLUSHER_DIRTY_PERCENT de blocos sujos) e, se houver blocos sujos demais ou
+ * algum bloco sujo há mais de FLUSHER_AGE_MS, grava-os em rodadas de até
+ * FLUSHER_BATCH_BLOCKS blocos, em ordem crescente e com blocos consecutivos
+ * agrupados em uma única escrita. Os blocos são copiados com o lock e gravados
+ * sem ele; um bloco só volta a ficar limpo se não foi alterado durante a
+ * gravação. O shell segura o lock enquanto executa um comando e o solta
+ * enquanto espera a próxima linha, então os comandos só esperam pelo flusher
+ * quando precisam despejar ou sincronizar blocos sujos.
+ *
+ * O flusher só é usado no backend file, no modo FS_DURABILITY_NONE e sem o
+ * log de escrita antecipada; nos outros casos os blocos sujos são gravados ao
+ * fim de cada comando.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/**
+ * @brief   Retorna o tempo do relógio monotônico em milissegundos.
+ */
+uint64_t fs_clock_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief   Compara dois buffers pelo número do bloco (para qsort).
+ */
+static int flusher_cmp(const void *a, const void *b)
+{
+    uint32_t x = (*(struct fs_buf *const *)a)->block;
+    uint32_t y = (*(struct fs_buf *const *)b)->block;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief   Verifica se há blocos sujos demais ou algum bloco sujo há tempo demais.
+ */
+static int flusher_due(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    if (!bc->dirty)
+        return 0;
+    if (bc->dirty >= fs->flusher.dirty_limit)
+        return 1;
+
+    uint64_t now = fs_clock_ms();
+    for (uint32_t i = 0; i < bc->used; ++i)
+        if (bc->bufs[i].dirty && now - bc->bufs[i].dirty_since >= FLUSHER_AGE_MS)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief   Grava uma rodada de blocos sujos. Chamada com o lock; solta-o durante as escritas.
+ *
+ * @return  Número de blocos que deixaram de ser sujos.
+ */
+static uint32_t flusher_round(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+    fs_flusher_t *fl = &fs->flusher;
+
+    struct fs_buf *list[FLUSHER_BATCH_BLOCKS];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < bc->used && n < FLUSHER_BATCH_BLOCKS; ++i) // Coleta os buffers sujos
+        if (bc->bufs[i].dirty)
+            list[n++] = &bc->bufs[i];
+    if (!n)
+        return 0;
+    qsort(list, n, sizeof(*list), flusher_cmp);
+
+    uint32_t blocks[FLUSHER_BATCH_BLOCKS]; // Blocos copiados e a geração de cada um
+    uint32_t gens[FLUSHER_BATCH_BLOCKS];
+    uint8_t *bufs[FLUSHER_BATCH_BLOCKS];
+    uint8_t ok[FLUSHER_BATCH_BLOCKS];
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        blocks[i] = list[i]->block;
+        gens[i] = list[i]->gen;
+        bufs[i] = fl->copy + (size_t)i * fs->block_size;
+        memcpy(bufs[i], list[i]->data, fs->block_size);
+    }
+
+    fl->busy = 1;
+    pthread_mutex_unlock(&fl->lock);
+    uint32_t i = 0;
+    while (i < n) // Grava sem o lock, uma escrita por sequência de blocos consecutivos
+    {
+        uint32_t run = 1;
+        while (fs->io->write_blocks && i + run < n && blocks[i + run] == blocks[i] + run)
+            run++;
+        int ret = run > 1 ? fs->io->write_blocks(fs, blocks[i], bufs + i, run) : fs->io->write_block(fs, blocks[i], bufs[i]);
+        memset(ok + i, ret == 0, run);
+        i += run;
+    }
+    pthread_mutex_lock(&fl->lock);
+    fl->busy = 0;
+    pthread_cond_broadcast(&fl->idle);
+
+    uint32_t cleaned = 0;
+    for (i = 0; i < n; ++i) // Só limpa os buffers que não mudaram durante a gravação
+    {
+        struct fs_buf *b = fs_buf_peek(fs, blocks[i]);
+        if (ok[i] && b && b->dirty && b->gen == gens[i])
+        {
+            b->dirty = 0;
+            bc->dirty--;
+            bc->flushed++;
+            cleaned++;
+        }
+    }
+    fl->rounds++;
+    return cleaned;
+}
+
+/**
+ * @brief   Laço da thread do flusher.
+ */
+static void *flusher_main(void *arg)
+{
+    ext2_fs_t *fs = arg;
+    fs_flusher_t *fl = &fs->flusher;
+
+    pthread_mutex_lock(&fl->lock);
+    while (!fl->stop)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_nsec += (long)FLUSHER_TICK_MS * 1000000;
+        ts.tv_sec += ts.tv_nsec / 1000000000;
+        ts.tv_nsec %= 1000000000;
+        pthread_cond_timedwait(&fl->wake, &fl->lock, &ts);
+
+        while (!fl->stop && flusher_due(fs) && flusher_round(fs))
+            ;
+    }
+    pthread_mutex_unlock(&fl->lock);
+    return NULL;
+}
+
+/**
+ * @brief   Cria a thread do flusher.
+ *
+ * Depois disso, todo acesso ao sistema de arquivos deve ser feito com o lock
+ * (fs_lock/fs_unlock).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_flusher_start(ext2_fs_t *fs)
+{
+    fs_flusher_t *fl = &fs->flusher;
+    memset(fl, 0, sizeof(*fl));
+    fl->dirty_limit = fs->bcache.capacity * FLUSHER_DIRTY_PERCENT / 100;
+    fl->copy = malloc((size_t)FLUSHER_BATCH_BLOCKS * fs->block_size);
+    if (!fl->copy)
+        return -1;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&fl->lock, NULL);
+    pthread_cond_init(&fl->wake, &attr);
+    pthread_cond_init(&fl->idle, NULL);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&fl->thread, NULL, flusher_main, fs) != 0)
+    {
+        pthread_cond_destroy(&fl->idle);
+        pthread_cond_destroy(&fl->wake);
+        pthread_mutex_destroy(&fl->lock);
+        free(fl->copy);
+        fl->copy = NULL;
+        return -1;
+    }
+    fl->running = 1;
+    return 0;
+}
+
+/**
+ * @brief   Encerra a thread do flusher. Deve ser chamada com o lock.
+ *
+ * Os blocos ainda sujos ficam na cache (são gravados por fs_sync).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_flusher_stop(ext2_fs_t *fs)
+{
+    fs_flusher_t *fl = &fs->flusher;
+    if (!fl->running)
+        return;
+
+    fl->stop = 1;
+    pthread_cond_signal(&fl->wake);
+    pthread_mutex_unlock(&fl->lock);
+    pthread_join(fl->thread, NULL);
+    fl->running = 0;
+
+    pthread_cond_destroy(&fl->idle);
+    pthread_cond_destroy(&fl->wake);
+    pthread_mutex_destroy(&fl->lock);
+    free(fl->copy);
+    fl->copy = NULL;
+}
+
+/**
+ * @brief   Acorda o flusher se a cache passou do limite de blocos sujos.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_flusher_kick(ext2_fs_t *fs)
+{
+    if (fs->flusher.running && fs->bcache.dirty >= fs->flusher.dirty_limit)
+        pthread_cond_signal(&fs->flusher.wake);
+}
+
+/**
+ * @brief   Espera o fim da rodada em andamento. Deve ser chamada com o lock.
+ *
+ * Usada antes de gravar blocos no primeiro plano, para que uma cópia antiga
+ * gravada pelo flusher não sobrescreva uma versão mais nova do mesmo bloco.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_flusher_wait(ext2_fs_t *fs)
+{
+    fs_flusher_t *fl = &fs->flusher;
+    while (fl->running && fl->busy)
+        pthread_cond_wait(&fl->idle, &fl->lock);
+}
+
+/**
+ * @brief   Obtém acesso exclusivo ao sistema de arquivos (sem flusher, não faz nada).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_lock(ext2_fs_t *fs)
+{
+    if (fs->flusher.running)
+        pthread_mutex_lock(&fs->flusher.lock);
+}
+
+/**
+ * @brief   Libera o acesso obtido com fs_lock.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_unlock(ext2_fs_t *fs)
+{
+    if (fs->flusher.running)
+        pthread_mutex_unlock(&fs->flusher.lock);
+}
@@ -0,0 +1,526 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    freeidx.c
+ *
+ * Índice em memória dos blocos livres, usado por fs_alloc_blocks.
+ *
+ * O índice tem dois níveis:
+ *  - um resumo por grupo, em uma árvore de segmentos com o maior número de
+ *    blocos livres de cada intervalo de grupos, que encontra em O(log grupos)
+ *    o primeiro grupo com espaço suficiente. As folhas acompanham
+ *    bg_free_blocks_count e são atualizadas por fs_write_group_desc;
+ *  - as sequências de blocos livres de cada grupo, em um vetor ordenado
+ *    montado a partir do bitmap de blocos na primeira alocação no grupo e
+ *    mantido por fs_alloc_blocks e fs_free_block. A busca por um bloco é
+ *    binária e as alterações só deslocam o vetor de um grupo.
+ *
+ * O bitmap continua sendo a referência: se o índice e o bitmap discordarem,
+ * as sequências do grupo são montadas de novo.
+ *
+ * O índice também guarda as janelas de reserva dos inodes (fs_reserve_blocks).
+ * Os blocos reservados continuam livres no bitmap, nos descritores e no
+ * superbloco, mas ficam fora das sequências livres e do resumo por grupo, de
+ * modo que as outras alocações não os usam e nada precisa ser devolvido antes
+ * de gravar a imagem.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/**
+ * @brief   Inicializa o índice de espaço livre com o resumo dos descritores de grupo.
+ *
+ * As sequências livres de cada grupo só são montadas quando o grupo é usado.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_freeidx_init(ext2_fs_t *fs)
+{
+    fs_freeidx_t *fi = &fs->freeidx;
+    memset(fi, 0, sizeof(*fi));
+
+    fi->leaves = 1;
+    while (fi->leaves < fs->groups_count) // Árvore completa com folhas em potência de 2
+        fi->leaves <<= 1;
+
+    fi->groups = calloc(fs->groups_count, sizeof(*fi->groups));
+    fi->tree = calloc(2 * (size_t)fi->leaves, sizeof(*fi->tree));
+    if (!fi->groups || !fi->tree)
+    {
+        fs_freeidx_destroy(fs);
+        return -1;
+    }
+
+    for (uint32_t g = 0; g < fs->groups_count; ++g)
+        fi->tree[fi->leaves + g] = fs->gdt[g].bg_free_blocks_count;
+    for (uint32_t n = fi->leaves - 1; n >= 1; --n)
+        fi->tree[n] = fi->tree[2 * n] > fi->tree[2 * n + 1] ? fi->tree[2 * n] : fi->tree[2 * n + 1];
+    return 0;
+}
+
+/**
+ * @brief   Libera a memória do índice de espaço livre.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_freeidx_destroy(ext2_fs_t *fs)
+{
+    fs_freeidx_t *fi = &fs->freeidx;
+    for (uint32_t g = 0; fi->groups && g < fs->groups_count; ++g)
+    {
+        free(fi->groups[g].runs);
+        free(fi->groups[g].resv);
+    }
+    free(fi->groups);
+    free(fi->tree);
+    memset(fi, 0, sizeof(*fi));
+}
+
+/**
+ * @brief   Atualiza no resumo o número de blocos livres de um grupo.
+ *
+ * Os blocos reservados do grupo não entram no resumo.
+ *
+ * @param   fs           Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group        Número do grupo.
+ * @param   free_blocks  Número de blocos livres do grupo (bg_free_blocks_count).
+ */
+void fs_freeidx_update(ext2_fs_t *fs, uint32_t group, uint32_t free_blocks)
+{
+    fs_freeidx_t *fi = &fs->freeidx;
+    if (!fi->tree || group >= fs->groups_count)
+        return;
+
+    uint32_t reserved = fi->groups ? fi->groups[group].reserved : 0;
+    uint32_t n = fi->leaves + group;
+    fi->tree[n] = free_blocks > reserved ? free_blocks - reserved : 0;
+    for (n /= 2; n >= 1; n /= 2) // Recalcula o máximo dos ancestrais
+    {
+        uint32_t max = fi->tree[2 * n] > fi->tree[2 * n + 1] ? fi->tree[2 * n] : fi->tree[2 * n + 1];
+        if (fi->tree[n] == max)
+            break;
+        fi->tree[n] = max;
+    }
+}
+
+/**
+ * @brief   Encontra o primeiro grupo a partir de 'start' com pelo menos 'min_free' blocos livres.
+ *
+ * @param   fs        Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   start     Primeiro grupo a considerar.
+ * @param   min_free  Número mínimo de blocos livres (pelo menos 1).
+ * @param   group     Recebe o número do grupo.
+ *
+ * @return  Retorna 0 se um grupo foi encontrado ou -1 caso contrário.
+ */
+int fs_freeidx_find_group(ext2_fs_t *fs, uint32_t start, uint32_t min_free, uint32_t *group)
+{
+    fs_freeidx_t *fi = &fs->freeidx;
+    if (!fi->tree || start >= fs->groups_count || !min_free || fi->tree[1] < min_free)
+        return -1;
+
+    uint32_t n = fi->leaves + start;
+    while (fi->tree[n] < min_free) // Sobe até um irmão à direita que tenha espaço
+    {
+        while (n > 1 && (n & 1))
+            n >>= 1;
+        if (n <= 1)
+            return -1;
+        n++;
+    }
+    while (n < fi->leaves) // Desce pelo filho mais à esquerda que ainda tem espaço
+        n = fi->tree[2 * n] >= min_free ? 2 * n : 2 * n + 1;
+    *group = n - fi->leaves;
+    return *group < fs->groups_count ? 0 : -1;
+}
+
+/**
+ * @brief   Acrescenta uma sequência livre ao fim da lista de um grupo.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int runs_append(struct fs_group_free *gf, uint32_t start, uint32_t len)
+{
+    if (gf->count == gf->cap)
+    {
+        uint32_t cap = gf->cap ? gf->cap * 2 : 16;
+        struct fs_free_run *runs = realloc(gf->runs, cap * sizeof(*runs));
+        if (!runs)
+            return -1;
+        gf->runs = runs;
+        gf->cap = cap;
+    }
+    gf->runs[gf->count].start = start;
+    gf->runs[gf->count].len = len;
+    gf->count++;
+    return 0;
+}
+
+/**
+ * @brief   Insere uma sequência livre na posição 'pos' da lista de um grupo.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int runs_insert(struct fs_group_free *gf, uint32_t pos, uint32_t start, uint32_t len)
+{
+    if (runs_append(gf, start, len) < 0) // Garante espaço no fim
+        return -1;
+    memmove(&gf->runs[pos + 1], &gf->runs[pos], (gf->count - 1 - pos) * sizeof(*gf->runs));
+    gf->runs[pos].start = start;
+    gf->runs[pos].len = len;
+    return 0;
+}
+
+/**
+ * @brief   Remove a sequência na posição 'pos' da lista de um grupo.
+ */
+static void runs_remove(struct fs_group_free *gf, uint32_t pos)
+{
+    memmove(&gf->runs[pos], &gf->runs[pos + 1], (gf->count - 1 - pos) * sizeof(*gf->runs));
+    gf->count--;
+}
+
+/**
+ * @brief   Procura a primeira sequência que começa depois de 'idx' (busca binária).
+ *
+ * @return  Posição da sequência (count se não houver).
+ */
+static uint32_t runs_upper(const struct fs_free_run *runs, uint32_t count, uint32_t idx)
+{
+    uint32_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (runs[mid].start <= idx)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief   Retira das sequências livres de um grupo os blocos de 'idx' a 'idx + len'.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 se os blocos não estavam livres no índice (ou em caso de erro).
+ */
+static int runs_take(struct fs_group_free *gf, uint32_t idx, uint32_t len)
+{
+    uint32_t pos = runs_upper(gf->runs, gf->count, idx);
+    struct fs_free_run *r = pos ? &gf->runs[pos - 1] : NULL; // Sequência que contém 'idx'
+    if (!r || idx + len > r->start + r->len)
+        return -1;
+
+    uint32_t end = r->start + r->len;
+    if (idx == r->start) // Retirada no início da sequência
+    {
+        r->start += len;
+        r->len -= len;
+        if (!r->len)
+            runs_remove(gf, pos - 1);
+    }
+    else if (idx + len == end) // Retirada no fim da sequência
+        r->len -= len;
+    else if (runs_insert(gf, pos, idx + len, end - idx - len) == 0) // Retirada no meio: divide a sequência
+        gf->runs[pos - 1].len = idx - gf->runs[pos - 1].start;
+    else
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief   Monta as sequências livres de um grupo a partir do seu bitmap de blocos.
+ *
+ * As janelas de reserva do grupo, livres no bitmap, ficam fora das sequências.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int group_load(ext2_fs_t *fs, uint32_t group, const uint8_t *bitmap)
+{
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    uint32_t nbits = fs_group_blocks(fs, group);
+    uint32_t pos = 0, start;
+
+    gf->count = 0;
+    gf->loaded = 0;
+    while (bitmap_find_clear(bitmap, nbits, pos, &start) == 0)
+    {
+        uint32_t end;
+        if (bitmap_find_set(bitmap, nbits, start, &end) < 0) // Livre até o fim do grupo
+            end = nbits;
+        if (runs_append(gf, start, end - start) < 0)
+            return -1;
+        pos = end;
+    }
+    for (uint32_t k = 0; k < gf->resv_count; ++k)
+        if (runs_take(gf, gf->resv[k].start, gf->resv[k].len) < 0)
+            return -1;
+    gf->loaded = 1;
+    fs->freeidx.loads++;
+    return 0;
+}
+
+/**
+ * @brief   Escolhe nas sequências livres de um grupo uma com 'want' blocos, dando preferência à posição 'from'.
+ *
+ * A procura começa no bloco 'from' (ou na sequência livre seguinte), continua
+ * até o fim do grupo e volta ao início. Se nenhuma sequência comportar o
+ * pedido, escolhe a maior delas.
+ *
+ * @return  Retorna 0 se o grupo tem alguma sequência livre ou -1 caso contrário.
+ */
+static int runs_pick(const struct fs_group_free *gf, uint32_t from, uint32_t want, uint32_t *idx, uint32_t *len)
+{
+    uint32_t pos = runs_upper(gf->runs, gf->count, from);
+    if (pos && gf->runs[pos - 1].start + gf->runs[pos - 1].len >= from + want) // A sequência que contém 'from' comporta o pedido
+    {
+        *idx = from;
+        *len = want;
+        return 0;
+    }
+
+    const struct fs_free_run *best = NULL;
+    for (uint32_t k = 0; k < gf->count; ++k)
+    {
+        const struct fs_free_run *r = &gf->runs[(pos + k) % gf->count]; // De 'from' até o fim e depois do início
+        if (r->len >= want)
+        {
+            *idx = r->start;
+            *len = want;
+            return 0;
+        }
+        if (!best || r->len > best->len)
+            best = r;
+    }
+    if (!best)
+        return -1;
+    *idx = best->start;
+    *len = best->len;
+    return 0;
+}
+
+/**
+ * @brief   Procura em um grupo uma sequência de 'want' blocos livres ou, se não houver, a maior disponível.
+ *
+ * Monta as sequências livres do grupo na primeira chamada. Se o índice
+ * apontar blocos que o bitmap marca como ocupados, as sequências do grupo
+ * são montadas de novo a partir do bitmap.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group   Número do grupo.
+ * @param   bitmap  Bitmap de blocos atual do grupo.
+ * @param   from    Bloco preferido (relativo ao grupo): a procura começa nele.
+ * @param   want    Número de blocos desejado.
+ * @param   idx     Recebe o primeiro bloco da sequência (relativo ao grupo).
+ * @param   len     Recebe o tamanho da sequência (igual a 'want' ou menor, se for a maior do grupo).
+ *
+ * @return  Retorna 0 se há blocos livres ou -1 se o grupo está cheio (ou em caso de erro).
+ */
+int fs_freeidx_find_run(ext2_fs_t *fs, uint32_t group, const uint8_t *bitmap, uint32_t from, uint32_t want, uint32_t *idx, uint32_t *len)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count || !want)
+        return -1;
+
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    if (!gf->loaded && group_load(fs, group, bitmap) < 0)
+        return -1;
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        uint32_t used;
+        if (runs_pick(gf, from, want, idx, len) < 0)
+            return -1;
+        if (bitmap_find_set(bitmap, *idx + *len, *idx, &used) < 0) // Confere a sequência no bitmap
+            return 0;
+        if (group_load(fs, group, bitmap) < 0) // Índice desatualizado: remonta a partir do bitmap
+            return -1;
+    }
+    return -1;
+}
+
+/**
+ * @brief   Retira do índice blocos que acabaram de ser alocados.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo.
+ * @param   idx    Primeiro bloco alocado (relativo ao grupo).
+ * @param   len    Número de blocos alocados.
+ */
+void fs_freeidx_take(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count || !fs->freeidx.groups[group].loaded)
+        return;
+
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    if (runs_take(gf, idx, len) < 0)
+        gf->loaded = 0; // Índice e bitmap discordam: remonta no próximo uso
+}
+
+/**
+ * @brief   Devolve ao índice blocos que acabaram de ser liberados, unindo sequências vizinhas.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo.
+ * @param   idx    Primeiro bloco liberado (relativo ao grupo).
+ * @param   len    Número de blocos liberados.
+ */
+void fs_freeidx_put(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count || !fs->freeidx.groups[group].loaded)
+        return;
+
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    uint32_t pos = runs_upper(gf->runs, gf->count, idx);
+    struct fs_free_run *prev = pos ? &gf->runs[pos - 1] : NULL;
+    struct fs_free_run *next = pos < gf->count ? &gf->runs[pos] : NULL;
+    if ((prev && prev->start + prev->len > idx) || (next && idx + len > next->start))
+    {
+        gf->loaded = 0; // Blocos já estavam livres no índice: remonta no próximo uso
+        return;
+    }
+
+    int join_prev = prev && prev->start + prev->len == idx;
+    int join_next = next && idx + len == next->start;
+    if (join_prev && join_next) // Preenche o espaço entre duas sequências
+    {
+        prev->len += len + next->len;
+        runs_remove(gf, pos);
+    }
+    else if (join_prev)
+        prev->len += len;
+    else if (join_next)
+    {
+        next->start = idx;
+        next->len += len;
+    }
+    else if (runs_insert(gf, pos, idx, len) < 0)
+        gf->loaded = 0;
+}
+
+/**
+ * @brief   Reserva blocos livres de um grupo, retirando-os das sequências livres e do resumo.
+ *
+ * Os blocos continuam livres no bitmap; só deixam de ser oferecidos por
+ * fs_freeidx_find_group e fs_freeidx_find_run até fs_freeidx_unreserve.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo (com as sequências já montadas, como depois de fs_freeidx_find_run).
+ * @param   idx    Primeiro bloco (relativo ao grupo).
+ * @param   len    Número de blocos.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_freeidx_reserve(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count || !fs->freeidx.groups[group].loaded || !len)
+        return -1;
+
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    if (gf->resv_count == gf->resv_cap) // Garante espaço antes de alterar as sequências
+    {
+        uint32_t cap = gf->resv_cap ? gf->resv_cap * 2 : 4;
+        struct fs_free_run *resv = realloc(gf->resv, cap * sizeof(*resv));
+        if (!resv)
+            return -1;
+        gf->resv = resv;
+        gf->resv_cap = cap;
+    }
+    if (runs_take(gf, idx, len) < 0)
+    {
+        gf->loaded = 0; // Blocos não estavam livres no índice: remonta no próximo uso
+        return -1;
+    }
+
+    uint32_t pos = runs_upper(gf->resv, gf->resv_count, idx);
+    memmove(&gf->resv[pos + 1], &gf->resv[pos], (gf->resv_count - pos) * sizeof(*gf->resv));
+    gf->resv[pos].start = idx;
+    gf->resv[pos].len = len;
+    gf->resv_count++;
+    gf->reserved += len;
+    fs_freeidx_update(fs, group, fs->gdt[group].bg_free_blocks_count);
+    return 0;
+}
+
+/**
+ * @brief   Desfaz a reserva de blocos do início ou do fim de uma janela (ou da janela inteira).
+ *
+ * Os blocos não voltam às sequências livres: quem os alocar marca o bitmap e
+ * quem os devolver chama fs_freeidx_put.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo.
+ * @param   idx    Primeiro bloco (relativo ao grupo).
+ * @param   len    Número de blocos.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 se os blocos não estavam reservados.
+ */
+int fs_freeidx_unreserve(ext2_fs_t *fs, uint32_t group, uint32_t idx, uint32_t len)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count || !len)
+        return -1;
+
+    struct fs_group_free *gf = &fs->freeidx.groups[group];
+    uint32_t pos = runs_upper(gf->resv, gf->resv_count, idx);
+    struct fs_free_run *r = pos ? &gf->resv[pos - 1] : NULL; // Janela que contém 'idx'
+    if (!r || (idx != r->start && idx + len != r->start + r->len) || idx + len > r->start + r->len)
+        return -1;
+
+    if (idx == r->start)
+        r->start += len;
+    r->len -= len;
+    if (!r->len)
+    {
+        memmove(r, r + 1, (gf->resv_count - pos) * sizeof(*gf->resv));
+        gf->resv_count--;
+    }
+    gf->reserved -= len;
+    fs_freeidx_update(fs, group, fs->gdt[group].bg_free_blocks_count);
+    return 0;
+}
+
+/**
+ * @brief   Pula a janela de reserva que contém um bloco, se houver.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo.
+ * @param   idx    Bloco (relativo ao grupo).
+ *
+ * @return  O primeiro bloco depois da janela que contém 'idx', ou o próprio 'idx' se ele não estiver reservado.
+ */
+uint32_t fs_freeidx_skip_reserved(ext2_fs_t *fs, uint32_t group, uint32_t idx)
+{
+    if (!fs->freeidx.groups || group >= fs->groups_count)
+        return idx;
+
+    const struct fs_group_free *gf = &fs->freeidx.groups[group];
+    uint32_t pos = runs_upper(gf->resv, gf->resv_count, idx);
+    if (pos && idx < gf->resv[pos - 1].start + gf->resv[pos - 1].len)
+        return gf->resv[pos - 1].start + gf->resv[pos - 1].len;
+    return idx;
+}
+
+/**
+ * @brief   Número de blocos livres e não reservados de um grupo, segundo o resumo.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   group  Número do grupo.
+ *
+ * @return  Número de blocos disponíveis para alocação no grupo.
+ */
+uint32_t fs_freeidx_avail(ext2_fs_t *fs, uint32_t group)
+{
+    fs_freeidx_t *fi = &fs->freeidx;
+    if (!fi->tree || group >= fs->groups_count)
+        return 0;
+    return fi->tree[fi->leaves + group];
+}
@@ -0,0 +1,707 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    icache.c
+ *
+ * Cache de inodes decodificados, indexada pelo número do inode.
+ *
+ * Cada entrada guarda uma cópia de struct ext2_inode, um contador de referências
+ * e um bit de sujeira. fs_read_inode/fs_write_inode passam por esta cache, e
+ * fs_iget/fs_iput permitem usar o inode em cache diretamente, sem cópias.
+ * Inodes sujos são copiados para a tabela de inodes (na cache de blocos) quando
+ * despejados ou em fs_icache_flush.
+ *
+ * Cada entrada também pode guardar a lista de extents do arquivo, montada sob
+ * demanda a partir do mapa de blocos e descartada quando o inode é alterado,
+ * e a janela de reserva de blocos do inode: blocos contíguos já marcados como
+ * usados, entregues um a um conforme o arquivo ou diretório cresce e
+ * devolvidos quando a entrada é despejada, o inode é liberado ou a imagem é fechada.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/**
+ * @brief   Calcula o índice da tabela hash para um inode.
+ *
+ * @param   ic   Ponteiro para a cache de inodes.
+ * @param   ino  Número do inode.
+ *
+ * @return  Índice da lista na tabela hash.
+ */
+static uint32_t icache_hash(fs_icache_t *ic, uint32_t ino)
+{
+    return (ino * 2654435761u) & ic->hash_mask; // Hash multiplicativo de Knuth
+}
+
+/**
+ * @brief   Obtém a entrada da cache a partir do ponteiro para o inode.
+ *
+ * @param   inode  Ponteiro retornado por fs_iget.
+ *
+ * @return  Entrada da cache que contém o inode.
+ */
+static struct fs_inode_ent *ent_of(struct ext2_inode *inode)
+{
+    void *p = (char *)inode - offsetof(struct fs_inode_ent, inode); // Entrada que contém o inode
+    return p;
+}
+
+/**
+ * @brief   Remove uma entrada da lista LRU.
+ */
+static void lru_unlink(fs_icache_t *ic, struct fs_inode_ent *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        ic->lru_head = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        ic->lru_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+/**
+ * @brief   Insere uma entrada no início da lista LRU (mais recente).
+ */
+static void lru_push_front(fs_icache_t *ic, struct fs_inode_ent *e)
+{
+    e->prev = NULL;
+    e->next = ic->lru_head;
+    if (ic->lru_head)
+        ic->lru_head->prev = e;
+    ic->lru_head = e;
+    if (!ic->lru_tail)
+        ic->lru_tail = e;
+}
+
+/**
+ * @brief   Insere uma entrada no fim da lista LRU (primeira a ser reaproveitada).
+ */
+static void lru_push_back(fs_icache_t *ic, struct fs_inode_ent *e)
+{
+    e->next = NULL;
+    e->prev = ic->lru_tail;
+    if (ic->lru_tail)
+        ic->lru_tail->next = e;
+    ic->lru_tail = e;
+    if (!ic->lru_head)
+        ic->lru_head = e;
+}
+
+/**
+ * @brief   Remove uma entrada da tabela hash.
+ */
+static void hash_unlink(fs_icache_t *ic, struct fs_inode_ent *e)
+{
+    struct fs_inode_ent **pp = &ic->hash[icache_hash(ic, e->ino)];
+    while (*pp && *pp != e)
+        pp = &(*pp)->hnext;
+    if (*pp)
+        *pp = e->hnext;
+    e->hnext = NULL;
+}
+
+/**
+ * @brief   Descarta a lista de extents de uma entrada.
+ */
+static void extents_drop(struct fs_inode_ent *e)
+{
+    free(e->extents);
+    e->extents = NULL;
+    e->nextents = 0;
+    e->mapped = 0;
+}
+
+/**
+ * @brief   Devolve ao índice de espaço livre os blocos restantes da janela de reserva de uma entrada.
+ */
+static void prealloc_drop(ext2_fs_t *fs, struct fs_inode_ent *e)
+{
+    if (e->prealloc_count)
+        fs_unreserve_blocks(fs, e->prealloc_block, e->prealloc_count);
+    e->prealloc_block = 0;
+    e->prealloc_count = 0;
+}
+
+/**
+ * @brief   Lê um inode da tabela de inodes (pela imagem em memória ou pela cache de blocos).
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino    Número do inode.
+ * @param   inode  Estrutura onde o inode será copiado.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int inode_table_read(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode)
+{
+    struct ext2_group_desc gd;
+    off_t off;
+    if (inode_loc(fs, ino, &gd, &off) < 0)
+        return -1;
+
+    uint8_t *p = fs_block_ptr(fs, (uint32_t)(off / fs->block_size)); // Imagem em memória: lê direto dela
+    if (!p)
+    {
+        struct fs_buf *b = fs_buf_get(fs, (uint32_t)(off / fs->block_size), 1);
+        if (!b)
+            return -1;
+        p = b->data;
+    }
+    memcpy(inode, p + off % fs->block_size, sizeof(*inode));
+    return 0;
+}
+
+/**
+ * @brief   Escreve um inode sujo na tabela de inodes (pela imagem em memória ou pela cache de blocos).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   e   Entrada da cache a ser escrita.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int icache_writeback(ext2_fs_t *fs, struct fs_inode_ent *e)
+{
+    struct ext2_group_desc gd;
+    off_t off;
+    if (inode_loc(fs, e->ino, &gd, &off) < 0)
+        return -1;
+
+    uint8_t *p = fs_block_ptr(fs, (uint32_t)(off / fs->block_size)); // Imagem em memória: grava direto nela
+    if (p)
+    {
+        memcpy(p + off % fs->block_size, &e->inode, sizeof(e->inode));
+        fs_io_dirty(fs, (uint32_t)(off / fs->block_size));
+    }
+    else
+    {
+        struct fs_buf *b = fs_buf_get(fs, (uint32_t)(off / fs->block_size), 1);
+        if (!b)
+            return -1;
+        memcpy(b->data + off % fs->block_size, &e->inode, sizeof(e->inode));
+        fs_buf_dirty(fs, b);
+    }
+
+    e->dirty = 0;
+    fs->icache.dirty--;
+    fs->icache.writebacks++;
+    return 0;
+}
+
+/**
+ * @brief   Inicializa a cache de inodes do sistema de arquivos.
+ *
+ * @param   fs        Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   capacity  Número máximo de inodes mantidos em memória.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_icache_init(ext2_fs_t *fs, uint32_t capacity)
+{
+    fs_icache_t *ic = &fs->icache;
+    memset(ic, 0, sizeof(*ic));
+
+    uint32_t buckets = 1;
+    while (buckets < capacity) // Tabela hash com tamanho potência de 2
+        buckets <<= 1;
+
+    ic->ents = calloc(capacity, sizeof(struct fs_inode_ent));
+    ic->hash = calloc(buckets, sizeof(struct fs_inode_ent *));
+    if (!ic->ents || !ic->hash)
+    {
+        fs_icache_destroy(fs);
+        return -1;
+    }
+    ic->hash_mask = buckets - 1;
+    ic->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief   Libera a memória da cache de inodes (sem escrever os inodes sujos).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_icache_destroy(ext2_fs_t *fs)
+{
+    fs_icache_t *ic = &fs->icache;
+    for (uint32_t i = 0; ic->ents && i < ic->used; ++i)
+        extents_drop(&ic->ents[i]);
+    free(ic->ents);
+    free(ic->hash);
+    memset(ic, 0, sizeof(*ic));
+}
+
+/**
+ * @brief   Obtém a entrada de um inode, carregando-o se necessário.
+ *
+ * @param   fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino   Número do inode.
+ * @param   read  Se 0, o inode não é lido (o chamador vai sobrescrevê-lo por inteiro).
+ *
+ * @return  Ponteiro para a entrada ou NULL em caso de erro.
+ */
+static struct fs_inode_ent *icache_get(ext2_fs_t *fs, uint32_t ino, int read)
+{
+    fs_icache_t *ic = &fs->icache;
+    if (ino == 0 || ino > fs->sb.s_inodes_count)
+        return NULL;
+
+    struct fs_inode_ent *e;
+    for (e = ic->hash[icache_hash(ic, ino)]; e; e = e->hnext)
+        if (e->ino == ino)
+            break;
+    if (e) // Acerto: move para o início da LRU
+    {
+        ic->hits++;
+        lru_unlink(ic, e);
+        lru_push_front(ic, e);
+        return e;
+    }
+
+    ic->misses++;
+    if (ic->used < ic->capacity) // Ainda há entradas livres
+        e = &ic->ents[ic->used++];
+    else // Despeja a entrada sem referências usada há mais tempo
+    {
+        for (e = ic->lru_tail; e && e->refcount; e = e->prev)
+            ;
+        if (!e)
+            return NULL; // Todas as entradas estão em uso
+        if (e->dirty && icache_writeback(fs, e) < 0)
+            return NULL;
+        prealloc_drop(fs, e);
+        lru_unlink(ic, e);
+        hash_unlink(ic, e);
+    }
+
+    e->ino = ino;
+    e->refcount = 0;
+    e->dirty = 0;
+    extents_drop(e);
+    e->ra_next = 0; // Sem leitura sequencial em andamento
+    e->ra_window = 0;
+    e->ra_end = 0;
+    if (read && inode_table_read(fs, ino, &e->inode) < 0)
+    {
+        lru_push_back(ic, e); // Entrada volta ao fim da LRU, fora da tabela hash
+        return NULL;
+    }
+
+    uint32_t h = icache_hash(ic, ino);
+    e->hnext = ic->hash[h];
+    ic->hash[h] = e;
+    lru_push_front(ic, e);
+    return e;
+}
+
+/**
+ * @brief   Obtém uma referência para o inode em cache.
+ *
+ * O ponteiro retornado permanece válido até a chamada correspondente a fs_iput.
+ * Alterações feitas no inode devem ser seguidas de fs_idirty.
+ *
+ * @param   fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino  Número do inode.
+ *
+ * @return  Ponteiro para o inode em cache ou NULL em caso de erro.
+ */
+struct ext2_inode *fs_iget(ext2_fs_t *fs, uint32_t ino)
+{
+    struct fs_inode_ent *e = icache_get(fs, ino, 1);
+    if (!e)
+        return NULL;
+    e->refcount++;
+    return &e->inode;
+}
+
+/**
+ * @brief   Libera uma referência obtida com fs_iget.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode  Ponteiro retornado por fs_iget.
+ */
+void fs_iput(ext2_fs_t *fs, struct ext2_inode *inode)
+{
+    (void)fs;
+    struct fs_inode_ent *e = ent_of(inode);
+    if (e->refcount)
+        e->refcount--;
+}
+
+/**
+ * @brief   Marca um inode em cache como sujo (modificado em memória).
+ *
+ * A lista de extents do inode, se houver, é descartada.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode  Ponteiro retornado por fs_iget.
+ */
+void fs_idirty(ext2_fs_t *fs, struct ext2_inode *inode)
+{
+    struct fs_inode_ent *e = ent_of(inode);
+    extents_drop(e); // O mapa de blocos pode ter mudado
+    if (!e->dirty)
+    {
+        e->dirty = 1;
+        fs->icache.dirty++;
+    }
+}
+
+/**
+ * @brief   Contexto para montar a lista de extents de um inode.
+ */
+struct extent_build
+{
+    struct fs_extent *ext; // Lista em formação
+    uint32_t count;        // Extents na lista
+    uint32_t cap;          // Capacidade alocada
+};
+
+/**
+ * @brief   Acrescenta à lista uma sequência do mapa de blocos (buracos são ignorados).
+ */
+static int extent_add_cb(const struct fs_block_run *run, void *user)
+{
+    struct extent_build *b = user;
+    if (!run->physical)
+        return 0;
+    if (b->count == b->cap)
+    {
+        uint32_t cap = b->cap ? b->cap * 2 : 8;
+        struct fs_extent *ext = realloc(b->ext, cap * sizeof(*ext));
+        if (!ext)
+            return -1;
+        b->ext = ext;
+        b->cap = cap;
+    }
+    b->ext[b->count].logical = run->logical;
+    b->ext[b->count].physical = run->physical;
+    b->ext[b->count].len = run->len;
+    b->count++;
+    return 0;
+}
+
+/**
+ * @brief   Obtém a lista de extents de um inode em cache, montando-a se necessário.
+ *
+ * Na primeira chamada o mapa de blocos (i_block e blocos indiretos) é percorrido
+ * com fs_map_blocks e as sequências contíguas são guardadas na entrada da cache.
+ * As chamadas seguintes reaproveitam a lista até o inode ser alterado (fs_idirty)
+ * ou despejado da cache. Os extents estão em ordem crescente de bloco lógico e
+ * blocos fora deles são buracos.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode  Ponteiro retornado por fs_iget (a lista vale enquanto a referência existir).
+ * @param   ext    Recebe o vetor de extents (NULL se o arquivo não tiver blocos).
+ * @param   count  Recebe o número de extents.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_inode_extents(ext2_fs_t *fs, struct ext2_inode *inode, const struct fs_extent **ext, uint32_t *count)
+{
+    struct fs_inode_ent *e = ent_of(inode);
+    if (e->mapped)
+    {
+        fs->icache.extent_hits++;
+        *ext = e->extents;
+        *count = e->nextents;
+        return 0;
+    }
+
+    struct extent_build b = {0};
+    if (fs_map_blocks(fs, inode, fs_file_blocks(fs, inode), 0, extent_add_cb, &b) != 0)
+    {
+        free(b.ext);
+        return -1;
+    }
+    if (b.count && b.count < b.cap) // Devolve a folga do vetor
+    {
+        struct fs_extent *shrunk = realloc(b.ext, b.count * sizeof(*b.ext));
+        if (shrunk)
+            b.ext = shrunk;
+    }
+
+    e->extents = b.ext;
+    e->nextents = b.count;
+    e->mapped = 1;
+    fs->icache.extent_builds++;
+    *ext = e->extents;
+    *count = e->nextents;
+    return 0;
+}
+
+/**
+ * @brief   Pede ao backend os blocos seguintes de um arquivo lido em sequência.
+ *
+ * Deve ser chamada antes de ler os blocos lógicos [logical, logical + count),
+ * depois de fs_inode_extents. Se a leitura começa onde a anterior terminou,
+ * a janela da leitura antecipada dobra (de FS_READAHEAD_MIN_BYTES até
+ * FS_READAHEAD_MAX_BYTES) e os blocos da janela após o trecho que ainda não
+ * foram pedidos são avisados ao backend (fs_io_willneed), que os lê enquanto
+ * o trecho atual é processado. Uma leitura fora de sequência zera a janela.
+ *
+ * @param   fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode    Ponteiro retornado por fs_iget.
+ * @param   logical  Primeiro bloco lógico da leitura.
+ * @param   count    Número de blocos da leitura.
+ */
+void fs_inode_readahead(ext2_fs_t *fs, struct ext2_inode *inode, uint32_t logical, uint32_t count)
+{
+    struct fs_inode_ent *e = ent_of(inode);
+    int sequential = logical == e->ra_next; // A primeira leitura a partir do bloco 0 também conta
+    e->ra_next = logical + count;
+    if (!sequential)
+    {
+        e->ra_window = 0;
+        e->ra_end = 0;
+        return;
+    }
+    if (!fs->io->willneed || !e->mapped || !e->nextents)
+        return;
+
+    uint32_t min = FS_READAHEAD_MIN_BYTES / fs->block_size;
+    uint32_t max = FS_READAHEAD_MAX_BYTES / fs->block_size;
+    e->ra_window = e->ra_window ? e->ra_window * 2 : min;
+    if (e->ra_window > max)
+        e->ra_window = max;
+
+    const struct fs_extent *last = &e->extents[e->nextents - 1];
+    uint32_t from = e->ra_end > logical + count ? e->ra_end : logical + count; // Blocos ainda não pedidos
+    uint32_t to = logical + count + e->ra_window;
+    if (to > last->logical + last->len) // Não passa do fim do arquivo
+        to = last->logical + last->len;
+    if (from >= to)
+        return;
+
+    uint32_t lo = 0, hi = e->nextents; // Primeiro extent que termina depois de 'from'
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (e->extents[mid].logical + e->extents[mid].len <= from)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (uint32_t i = lo; i < e->nextents && e->extents[i].logical < to; ++i) // Um aviso por sequência contígua
+    {
+        const struct fs_extent *x = &e->extents[i];
+        uint32_t a = x->logical > from ? x->logical : from;
+        uint32_t b = x->logical + x->len < to ? x->logical + x->len : to;
+        fs_io_willneed(fs, x->physical + (a - x->logical), b - a);
+        fs->icache.readahead += b - a;
+    }
+    e->ra_end = to;
+}
+
+/**
+ * @brief   Número de blocos da janela de reserva de um inode.
+ *
+ * Usa s_prealloc_dir_blocks para diretórios e s_prealloc_blocks para os
+ * demais arquivos; se o superbloco não definir o valor, usa FS_PREALLOC_DEFAULT.
+ */
+static uint32_t prealloc_size(ext2_fs_t *fs, const struct ext2_inode *inode)
+{
+    uint32_t n = (inode->i_mode & EXT2_S_IFDIR) == EXT2_S_IFDIR ? fs->sb.s_prealloc_dir_blocks : fs->sb.s_prealloc_blocks;
+    return n ? n : FS_PREALLOC_DEFAULT;
+}
+
+/**
+ * @brief   Aloca o bloco de um bloco lógico de um arquivo, usando a janela de reserva do inode.
+ *
+ * Se a janela do inode continua exatamente onde o arquivo termina (o bloco
+ * preferido de fs_block_goal), o bloco sai dela com fs_alloc_reserved. Caso
+ * contrário, a janela antiga é devolvida e uma nova sequência é reservada
+ * perto do bloco preferido com fs_reserve_blocks: o primeiro bloco é alocado
+ * e os demais formam a nova janela (o primeiro bloco lógico não abre janela).
+ * Assim arquivos que crescem intercalados continuam contíguos. A janela fica
+ * só no índice de espaço livre: seus blocos continuam livres no bitmap, e a
+ * imagem gravada nunca tem blocos usados sem dono.
+ *
+ * @param   fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino        Número do inode.
+ * @param   inode      Conteúdo atual do inode (usado para escolher o bloco preferido).
+ * @param   logical    Bloco lógico que será alocado.
+ * @param   out_block  Recebe o número do bloco alocado.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_inode_alloc_block(ext2_fs_t *fs, uint32_t ino, const struct ext2_inode *inode, uint32_t logical, uint32_t *out_block)
+{
+    uint32_t goal = fs_block_goal(fs, ino, inode, logical);
+    struct fs_inode_ent *e = icache_get(fs, ino, 1);
+    if (!e) // Sem entrada na cache: aloca sem reserva
+        return fs_alloc_block(fs, goal, out_block);
+
+    if (e->prealloc_count && e->prealloc_block == goal && fs_alloc_reserved(fs, goal) == 0) // Continua a janela
+    {
+        *out_block = e->prealloc_block++;
+        e->prealloc_count--;
+        return 0;
+    }
+    prealloc_drop(fs, e);
+    if (logical == 0) // O primeiro bloco não abre janela: a maioria dos arquivos e diretórios não passa dele
+        return fs_alloc_block(fs, goal, out_block);
+
+    uint32_t first, len;
+    if (fs_reserve_blocks(fs, goal, 1 + prealloc_size(fs, inode), &first, &len) < 0)
+        return -1;
+    if (fs_alloc_reserved(fs, first) < 0)
+    {
+        fs_unreserve_blocks(fs, first, len);
+        return -1;
+    }
+    *out_block = first;
+    e->prealloc_block = first + 1;
+    e->prealloc_count = len - 1;
+    return 0;
+}
+
+/**
+ * @brief   Devolve os blocos não usados da janela de reserva de um inode.
+ *
+ * @param   fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino  Número do inode.
+ */
+void fs_prealloc_release(ext2_fs_t *fs, uint32_t ino)
+{
+    fs_icache_t *ic = &fs->icache;
+    if (!ic->hash)
+        return;
+    for (struct fs_inode_ent *e = ic->hash[icache_hash(ic, ino)]; e; e = e->hnext)
+        if (e->ino == ino)
+            prealloc_drop(fs, e);
+}
+
+/**
+ * @brief   Copia todos os inodes sujos para a tabela de inodes.
+ *
+ * Os blocos da tabela de inodes alterados ficam sujos na cache de blocos
+ * e são escritos na imagem por fs_bcache_flush.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_icache_flush(ext2_fs_t *fs)
+{
+    fs_icache_t *ic = &fs->icache;
+    int ret = 0;
+    for (uint32_t i = 0; i < ic->used && ic->dirty; ++i)
+        if (ic->ents[i].dirty && icache_writeback(fs, &ic->ents[i]) < 0)
+            ret = -1;
+    return ret;
+}
+
+/**
+ * @brief   Lê um inode do sistema de arquivos EXT2.
+ *
+ * Esta função copia o inode especificado por 'ino' para a estrutura 'inode'.
+ * O inode é obtido da cache de inodes e só é lido da tabela de inodes em caso de falta.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param ino   Número do inode a ser lido.
+ * @param inode Ponteiro para a estrutura onde o inode lido será armazenado.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na leitura.
+ */
+int fs_read_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode)
+{
+    struct fs_inode_ent *e = icache_get(fs, ino, 1);
+    if (!e)
+        return -1;
+    *inode = e->inode;
+    return 0;
+}
+
+/**
+ * @brief   Escreve um inode no sistema de arquivos EXT2.
+ *
+ * Esta função copia os dados do inode para a cache de inodes e o marca como sujo.
+ * A escrita na tabela de inodes é adiada até o despejo da entrada ou fs_sync.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param ino   Número do inode a ser escrito.
+ * @param inode Ponteiro para a estrutura contendo os dados do inode a serem escritos.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na escrita.
+ */
+int fs_write_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode)
+{
+    struct fs_inode_ent *e = icache_get(fs, ino, 0);
+    if (!e)
+        return -1;
+    if (&e->inode != inode)
+        e->inode = *inode;
+    fs_idirty(fs, &e->inode);
+    return 0;
+}
+
+/**
+ * @brief   Compara dois números de 32 bits (para qsort).
+ */
+static int u32_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief   Carrega antecipadamente os blocos da tabela de inodes de vários inodes.
+ *
+ * Os blocos da tabela que contêm os inodes são calculados, ordenados e lidos
+ * em ordem crescente pela leitura antecipada da cache de blocos, com uma
+ * leitura por sequência de blocos consecutivos. Inodes que já estão na cache
+ * de inodes são ignorados.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inos   Números dos inodes (em qualquer ordem).
+ * @param   count  Número de inodes.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_icache_prefetch(ext2_fs_t *fs, const uint32_t *inos, uint32_t count)
+{
+    if (fs->map || !count) // Imagem em memória: nada a carregar
+        return 0;
+
+    uint32_t *blocks = malloc(count * sizeof(*blocks));
+    if (!blocks)
+        return -1;
+
+    fs_icache_t *ic = &fs->icache;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        struct fs_inode_ent *e;
+        for (e = ic->hash[icache_hash(ic, inos[i])]; e && e->ino != inos[i]; e = e->hnext)
+            ;
+        struct ext2_group_desc gd;
+        off_t off;
+        if (e || inode_loc(fs, inos[i], &gd, &off) < 0) // Já em cache ou inválido
+            continue;
+        blocks[n++] = (uint32_t)(off / fs->block_size);
+    }
+
+    qsort(blocks, n, sizeof(*blocks), u32_cmp);
+    uint32_t m = 0; // Remove os blocos repetidos
+    for (uint32_t i = 0; i < n; ++i)
+        if (!m || blocks[m - 1] != blocks[i])
+            blocks[m++] = blocks[i];
+
+    int ret = fs_bcache_readahead(fs, blocks, m);
+    free(blocks);
+    return ret;
+}
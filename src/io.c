@@ -0,0 +1,511 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "utils.h"
+
+/**
+ * @file    io.c
+ *
+ * Backends de E/S da imagem. Cada backend implementa as operações de
+ * struct fs_io_ops e é escolhido em fs_open:
+ *
+ *  - file: pread/pwrite no descritor da imagem (com a cache de blocos por cima);
+ *  - mmap: a imagem inteira é mapeada em memória e gravada com msync;
+ *  - ram:  a imagem inteira é carregada em memória na abertura e os blocos
+ *          alterados são gravados de volta no fs_sync e no fechamento.
+ *
+ * Os backends mmap e ram deixam a imagem em fs->map; nesse caso os blocos são
+ * acessados diretamente em memória, sem passar pela cache de blocos.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+/* --------------- Auxiliares --------------- */
+
+/**
+ * @brief   Lê um trecho do descritor da imagem, repetindo leituras curtas.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro ou fim do arquivo.
+ */
+static int pread_full(int fd, void *buf, size_t len, off_t off)
+{
+    uint8_t *p = buf;
+    while (len)
+    {
+        ssize_t n = pread(fd, p, len, off);
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Escreve um trecho no descritor da imagem, repetindo escritas curtas.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int pwrite_full(int fd, const void *buf, size_t len, off_t off)
+{
+    const uint8_t *p = buf;
+    while (len)
+    {
+        ssize_t n = pwrite(fd, p, len, off);
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Lê trechos consecutivos do descritor da imagem com preadv,
+ *          repetindo leituras curtas (o vetor 'iov' é alterado).
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro ou fim do arquivo.
+ */
+static int preadv_full(int fd, struct iovec *iov, int iovcnt, off_t off)
+{
+    while (iovcnt)
+    {
+        ssize_t n = preadv(fd, iov, iovcnt, off);
+        if (n <= 0)
+            return -1;
+        off += n;
+        while (iovcnt && (size_t)n >= iov->iov_len) // Pula os trechos lidos por inteiro
+        {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt) // Trecho lido pela metade
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   Escreve trechos consecutivos no descritor da imagem com pwritev,
+ *          repetindo escritas curtas (o vetor 'iov' é alterado).
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int pwritev_full(int fd, struct iovec *iov, int iovcnt, off_t off)
+{
+    while (iovcnt)
+    {
+        ssize_t n = pwritev(fd, iov, iovcnt, off);
+        if (n <= 0)
+            return -1;
+        off += n;
+        while (iovcnt && (size_t)n >= iov->iov_len) // Pula os trechos escritos por inteiro
+        {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt) // Trecho escrito pela metade
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   Verifica se um trecho está dentro da imagem em memória.
+ */
+static int map_contains(ext2_fs_t *fs, size_t len, off_t off)
+{
+    return off >= 0 && (size_t)off <= fs->map_size && len <= fs->map_size - (size_t)off;
+}
+
+/* --------------- Backend file (pread/pwrite) --------------- */
+
+static int file_open(ext2_fs_t *fs)
+{
+    (void)fs;
+    return 0;
+}
+
+static void file_close(ext2_fs_t *fs)
+{
+    (void)fs;
+}
+
+static int file_read_block(ext2_fs_t *fs, uint32_t block, void *buf)
+{
+    return pread_full(fs->fd, buf, fs->block_size, fs_block_offset(fs, block));
+}
+
+static int file_write_block(ext2_fs_t *fs, uint32_t block, const void *buf)
+{
+    return pwrite_full(fs->fd, buf, fs->block_size, fs_block_offset(fs, block));
+}
+
+static int file_write_blocks(ext2_fs_t *fs, uint32_t block, uint8_t *const *bufs, uint32_t count)
+{
+    struct iovec iov[FS_IOV_MAX];
+    uint32_t max = fs_io_max_blocks(fs);
+    while (count)
+    {
+        uint32_t n = count < max ? count : max;
+        for (uint32_t i = 0; i < n; ++i)
+            iov[i] = (struct iovec){bufs[i], fs->block_size};
+        if (pwritev_full(fs->fd, iov, (int)n, fs_block_offset(fs, block)) < 0)
+            return -1;
+        block += n;
+        bufs += n;
+        count -= n;
+    }
+    return 0;
+}
+
+static int file_read_vec(ext2_fs_t *fs, struct iovec *iov, int iovcnt, off_t off)
+{
+    return preadv_full(fs->fd, iov, iovcnt, off);
+}
+
+static int file_read_range(ext2_fs_t *fs, void *buf, size_t len, off_t off)
+{
+    return pread_full(fs->fd, buf, len, off);
+}
+
+static int file_write_range(ext2_fs_t *fs, const void *buf, size_t len, off_t off)
+{
+    return pwrite_full(fs->fd, buf, len, off);
+}
+
+static void file_willneed(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    posix_fadvise(fs->fd, fs_block_offset(fs, block), (off_t)count * fs->block_size, POSIX_FADV_WILLNEED); // O kernel lê os blocos em segundo plano
+}
+
+static int file_flush(ext2_fs_t *fs)
+{
+    (void)fs; // As escritas já foram entregues ao kernel por pwrite
+    return 0;
+}
+
+static off_t file_size(ext2_fs_t *fs)
+{
+    struct stat st;
+    if (fstat(fs->fd, &st) < 0)
+        return -1;
+    return st.st_size;
+}
+
+/* --------------- Operações comuns à imagem em memória --------------- */
+
+static int map_read_block(ext2_fs_t *fs, uint32_t block, void *buf)
+{
+    void *p = fs_block_ptr(fs, block);
+    if (!p)
+        return -1;
+    memcpy(buf, p, fs->block_size);
+    return 0;
+}
+
+static int map_read_range(ext2_fs_t *fs, void *buf, size_t len, off_t off)
+{
+    if (!map_contains(fs, len, off))
+        return -1;
+    memcpy(buf, fs->map + off, len);
+    return 0;
+}
+
+static off_t map_size(ext2_fs_t *fs)
+{
+    return (off_t)fs->map_size;
+}
+
+/* --------------- Backend mmap --------------- */
+
+static int mmap_open(ext2_fs_t *fs)
+{
+    struct stat st;
+    if (fstat(fs->fd, &st) < 0 || st.st_size <= 0)
+        return -1;
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fs->fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    fs->map = map;
+    fs->map_size = (size_t)st.st_size;
+    return 0;
+}
+
+static void mmap_close(ext2_fs_t *fs)
+{
+    munmap(fs->map, fs->map_size);
+    fs->map = NULL;
+}
+
+static int mmap_write_block(ext2_fs_t *fs, uint32_t block, const void *buf)
+{
+    void *p = fs_block_ptr(fs, block);
+    if (!p)
+        return -1;
+    memcpy(p, buf, fs->block_size); // Gravado na imagem pelo msync em fs_sync
+    return 0;
+}
+
+static int mmap_write_range(ext2_fs_t *fs, const void *buf, size_t len, off_t off)
+{
+    if (!map_contains(fs, len, off))
+        return -1;
+    memcpy(fs->map + off, buf, len);
+    return 0;
+}
+
+static void mmap_willneed(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t off = (size_t)fs_block_offset(fs, block);
+    size_t len = (size_t)count * fs->block_size;
+    if (!map_contains(fs, len, (off_t)off))
+        return;
+    size_t start = off & ~(page - 1); // madvise exige endereço alinhado à página
+    madvise(fs->map + start, off + len - start, MADV_WILLNEED);
+}
+
+static int mmap_flush(ext2_fs_t *fs)
+{
+    return msync(fs->map, fs->map_size, MS_SYNC);
+}
+
+/* --------------- Backend ram --------------- */
+
+#define RAM_CHUNK_SIZE EXT2_MIN_BLOCK_SIZE // Granularidade do controle de alterações (independe do tamanho do bloco)
+
+struct ram_image // Estado do backend ram
+{
+    uint32_t nchunks; // Número de trechos da imagem (o último pode ser parcial)
+    uint8_t *dirty;   // Bitmap dos trechos alterados desde o último flush
+};
+
+/**
+ * @brief   Marca como alterados os trechos de RAM_CHUNK_SIZE que cobrem uma região da imagem.
+ */
+static void ram_dirty_range(ext2_fs_t *fs, size_t len, off_t off)
+{
+    struct ram_image *r = fs->io_data;
+    if (!len)
+        return;
+    uint32_t first = (uint32_t)(off / RAM_CHUNK_SIZE);
+    uint32_t last = (uint32_t)((off + (off_t)len - 1) / RAM_CHUNK_SIZE);
+    for (uint32_t b = first; b <= last && b < r->nchunks; ++b)
+        r->dirty[BIT_BYTE(b)] |= BIT_MASK(b);
+}
+
+static int ram_open(ext2_fs_t *fs)
+{
+    off_t size = file_size(fs);
+    if (size <= 0)
+        return -1;
+
+    struct ram_image *r = calloc(1, sizeof(*r));
+    uint8_t *image = malloc((size_t)size);
+    if (r)
+    {
+        r->nchunks = (uint32_t)((size + RAM_CHUNK_SIZE - 1) / RAM_CHUNK_SIZE);
+        r->dirty = calloc((r->nchunks + 7) / 8, 1);
+    }
+    if (!r || !r->dirty || !image || pread_full(fs->fd, image, (size_t)size, 0) < 0) // Carrega a imagem inteira
+    {
+        if (r)
+            free(r->dirty);
+        free(r);
+        free(image);
+        return -1;
+    }
+
+    fs->map = image;
+    fs->map_size = (size_t)size;
+    fs->io_data = r;
+    return 0;
+}
+
+static void ram_close(ext2_fs_t *fs)
+{
+    struct ram_image *r = fs->io_data;
+    free(r->dirty);
+    free(r);
+    free(fs->map);
+    fs->io_data = NULL;
+    fs->map = NULL;
+}
+
+static int ram_write_block(ext2_fs_t *fs, uint32_t block, const void *buf)
+{
+    void *p = fs_block_ptr(fs, block);
+    if (!p)
+        return -1;
+    memcpy(p, buf, fs->block_size);
+    ram_dirty_range(fs, fs->block_size, fs_block_offset(fs, block));
+    return 0;
+}
+
+static int ram_write_range(ext2_fs_t *fs, const void *buf, size_t len, off_t off)
+{
+    if (!map_contains(fs, len, off))
+        return -1;
+    memcpy(fs->map + off, buf, len);
+    ram_dirty_range(fs, len, off);
+    return 0;
+}
+
+static void ram_dirty(ext2_fs_t *fs, uint32_t block)
+{
+    ram_dirty_range(fs, fs->block_size, fs_block_offset(fs, block));
+}
+
+/**
+ * @brief   Grava na imagem os trechos alterados, uma escrita por sequência contígua.
+ */
+static int ram_flush(ext2_fs_t *fs)
+{
+    struct ram_image *r = fs->io_data;
+    uint32_t b = 0;
+    while (b < r->nchunks)
+    {
+        if (!(r->dirty[BIT_BYTE(b)] & BIT_MASK(b)))
+        {
+            b++;
+            continue;
+        }
+
+        uint32_t end = b; // Encontra o fim da sequência de trechos alterados
+        while (end < r->nchunks && (r->dirty[BIT_BYTE(end)] & BIT_MASK(end)))
+        {
+            r->dirty[BIT_BYTE(end)] &= (uint8_t)~BIT_MASK(end);
+            end++;
+        }
+
+        off_t off = (off_t)b * RAM_CHUNK_SIZE;
+        size_t len = (size_t)(end - b) * RAM_CHUNK_SIZE;
+        if ((size_t)off + len > fs->map_size) // O último trecho da imagem pode ser parcial
+            len = fs->map_size - (size_t)off;
+        if (pwrite_full(fs->fd, fs->map + off, len, off) < 0)
+        {
+            for (uint32_t i = b; i < end; ++i) // Mantém os trechos marcados para a próxima tentativa
+                r->dirty[BIT_BYTE(i)] |= BIT_MASK(i);
+            return -1;
+        }
+        b = end;
+    }
+    return 0;
+}
+
+/* --------------- Tabelas de operações --------------- */
+
+const struct fs_io_ops fs_io_file = {
+    .name = "file",
+    .open = file_open,
+    .close = file_close,
+    .read_block = file_read_block,
+    .write_block = file_write_block,
+    .write_blocks = file_write_blocks,
+    .read_vec = file_read_vec,
+    .read_range = file_read_range,
+    .write_range = file_write_range,
+    .dirty = NULL,
+    .willneed = file_willneed,
+    .flush = file_flush,
+    .size = file_size,
+};
+
+const struct fs_io_ops fs_io_mmap = {
+    .name = "mmap",
+    .open = mmap_open,
+    .close = mmap_close,
+    .read_block = map_read_block,
+    .write_block = mmap_write_block,
+    .write_blocks = NULL, // Blocos escritos um a um diretamente em memória
+    .read_vec = NULL,     // Leituras são cópias da memória, sem chamadas ao kernel
+    .read_range = map_read_range,
+    .write_range = mmap_write_range,
+    .dirty = NULL, // msync grava o mapeamento inteiro
+    .willneed = mmap_willneed,
+    .flush = mmap_flush,
+    .size = map_size,
+};
+
+const struct fs_io_ops fs_io_ram = {
+    .name = "ram",
+    .open = ram_open,
+    .close = ram_close,
+    .read_block = map_read_block,
+    .write_block = ram_write_block,
+    .write_blocks = NULL, // Blocos escritos um a um diretamente em memória
+    .read_vec = NULL,     // Leituras são cópias da memória, sem chamadas ao kernel
+    .read_range = map_read_range,
+    .write_range = ram_write_range,
+    .dirty = ram_dirty,
+    .willneed = NULL, // A imagem já está inteira em memória
+    .flush = ram_flush,
+    .size = map_size,
+};
+
+/**
+ * @brief   Informa ao backend que um bloco foi alterado diretamente pelo ponteiro de fs_block_ptr.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   block   Número do bloco alterado.
+ */
+void fs_io_dirty(ext2_fs_t *fs, uint32_t block)
+{
+    if (fs->io->dirty)
+        fs->io->dirty(fs, block);
+}
+
+/**
+ * @brief   Avisa ao backend que blocos consecutivos serão lidos em breve.
+ *
+ * No backend file o aviso vira posix_fadvise(POSIX_FADV_WILLNEED) e no mmap
+ * vira madvise(MADV_WILLNEED); o kernel começa a ler os blocos sem bloquear
+ * quem chamou. No backend ram não faz nada.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   block  Primeiro bloco.
+ * @param   count  Número de blocos.
+ */
+void fs_io_willneed(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    if (fs->io->willneed && count)
+        fs->io->willneed(fs, block, count);
+}
+
+/**
+ * @brief   Número máximo de blocos em uma leitura ou escrita agrupada (preadv/pwritev).
+ *
+ * Deriva de fs->io_max, limitado a FS_IOV_MAX e a pelo menos um bloco.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Número de blocos.
+ */
+uint32_t fs_io_max_blocks(ext2_fs_t *fs)
+{
+    uint32_t n = fs->io_max / fs->block_size;
+    if (n > FS_IOV_MAX)
+        n = FS_IOV_MAX;
+    return n ? n : 1;
+}
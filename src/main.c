@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <unistd.h>
 
 #include "commands.h"
 #include "errors.h"
@@ -77,10 +78,10 @@ int tokenize(char *line, char **argv)
 // Tabela de comandos
 struct command_entry cmd_table[] = {
     {"info", cmd_info, "Exibe informações do disco e do sistema de arquivos."},
-    {"ls", cmd_ls, "Lista os arquivos e diretórios do diretório corrente."},
+    {"ls", cmd_ls, "Lista os arquivos e diretórios do diretório corrente (-l para o formato longo)."},
     {"cd", cmd_cd, "Altera o diretório corrente para o definido como <path>."},
     {"pwd", cmd_pwd, "Exibe o diretório corrente (caminho absoluto)."},
-    {"cat", cmd_cat, "Exibe o conteúdo de um arquivo <file> no formato texto."},
+    {"cat", cmd_cat, "Exibe o conteúdo de um arquivo <file> no formato texto (ou o trecho <offset> <length>)."},
     {"attr", cmd_attr, "Exibe os atributos de um arquivo (<file>) ou diretório (<dir>)."},
     {"touch", cmd_touch, "Cria o arquivo <file> com conteúdo vazio."},
     {"mkdir", cmd_mkdir, "Cria o diretório <dir> vazio."},
@@ -90,6 +91,7 @@ struct command_entry cmd_table[] = {
     {"cp", cmd_cp, "Copia um arquivo de origem (<source_path>) para destino (<target_path>)."},
     {"mv", cmd_mv, "Move um arquivo da imagem EXT2 para o host (remove após copiar)."},
     {"print", cmd_print, "Exibe informações do sistema EXT2."},
+    {"sync", cmd_sync, "Grava na imagem as alterações pendentes em memória."},
     CMD_TABLE_END};
 
 /**
@@ -106,6 +108,29 @@ void mostrar_help()
     puts("  exit     - Finaliza o shell.");
 }
 
+/**
+ * @brief   Mostra a forma de uso do programa.
+ * @param   prog Nome do executável.
+ * @return  Nenhum valor é retornado.
+ */
+void mostrar_uso(const char *prog)
+{
+    fprintf(stderr, "Uso: %s [-m | -r] [-u] [-d none|command|strict] [-w] [-f] [-v KiB] <imagem.ext2>\n", prog);
+    fprintf(stderr, "  -m  mapeia a imagem inteira em memória (mmap)\n");
+    fprintf(stderr, "  -r  carrega a imagem inteira em memória e a grava de volta no sync e ao sair\n");
+    fprintf(stderr, "  -u  lê os blocos dos arquivos em lote com io_uring\n");
+    fprintf(stderr, "  -d  durabilidade: none (grava só no sync e ao sair, sem fsync; padrão),\n");
+    fprintf(stderr, "      command (grava e faz fsync ao fim de cada comando) ou strict (como\n");
+    fprintf(stderr, "      command, gravando blocos e inodes antes dos descritores e do superbloco)\n");
+    fprintf(stderr, "  -w  grava cada comando antes no log <imagem>.wal, reaplicado na próxima\n");
+    fprintf(stderr, "      abertura se a gravação for interrompida (não pode ser usada com -m ou -r)\n");
+    fprintf(stderr, "  -f  grava os blocos sujos em segundo plano enquanto o shell espera um comando\n");
+    fprintf(stderr, "      (apenas com -d none e sem -m, -r ou -w; a imagem pode ficar inconsistente\n");
+    fprintf(stderr, "      se o programa for interrompido antes do sync)\n");
+    fprintf(stderr, "  -v  tamanho máximo em KiB de uma leitura ou escrita agrupada com preadv/pwritev\n");
+    fprintf(stderr, "      (padrão %d)\n", FS_IO_MAX_DEFAULT / 1024);
+}
+
 /**
  * @brief   Função principal do shell.
  *
@@ -118,31 +143,90 @@ void mostrar_help()
  */
 int main(int argc, char **argv)
 {
-    if (argc != 2)
+    int flags = 0;                       // Modos de abertura da imagem
+    uint32_t io_max = FS_IO_MAX_DEFAULT; // Tamanho máximo de uma leitura ou escrita agrupada
+    int opt;
+    while ((opt = getopt(argc, argv, "mrud:wfv:")) != -1)
     {
-        fprintf(stderr, "Uso: %s <imagem.ext2>\n", argv[0]);
+        switch (opt)
+        {
+        case 'm': // Mapeia a imagem em memória
+            flags |= FS_OPEN_MMAP;
+            break;
+        case 'r': // Carrega a imagem em memória
+            flags |= FS_OPEN_RAM;
+            break;
+        case 'u': // Leituras em lote com io_uring
+            flags |= FS_OPEN_URING;
+            break;
+        case 'd': // Modo de durabilidade
+            if (strcmp(optarg, "command") == 0)
+                flags |= FS_OPEN_SYNC_COMMAND;
+            else if (strcmp(optarg, "strict") == 0)
+                flags |= FS_OPEN_SYNC_STRICT;
+            else if (strcmp(optarg, "none") != 0)
+            {
+                mostrar_uso(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'w': // Log de escrita antecipada
+            flags |= FS_OPEN_WAL;
+            break;
+        case 'f': // Blocos sujos gravados em segundo plano
+            flags |= FS_OPEN_FLUSHER;
+            break;
+        case 'v': // Tamanho máximo de uma leitura ou escrita agrupada
+        {
+            char *end;
+            unsigned long kib = strtoul(optarg, &end, 10);
+            if (*end || optarg[0] == '-' || kib == 0 || kib > UINT32_MAX / 1024)
+            {
+                mostrar_uso(argv[0]);
+                return EXIT_FAILURE;
+            }
+            io_max = (uint32_t)(kib * 1024);
+            break;
+        }
+        default: // Opção inválida
+            mostrar_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int map = flags & (FS_OPEN_MMAP | FS_OPEN_RAM);
+    if (optind != argc - 1 || map == (FS_OPEN_MMAP | FS_OPEN_RAM) || (map && (flags & FS_OPEN_WAL))) // Exige uma imagem, um único backend e o log só no backend file
+    {
+        mostrar_uso(argv[0]);
         return EXIT_FAILURE;
     }
 
-    ext2_fs_t *fs = fs_open(argv[1]); // Abre a imagem do sistema de arquivos
+    ext2_fs_t *fs = fs_open(argv[optind], flags); // Abre a imagem do sistema de arquivos
     if (!fs)
     {
         print_error_with_message("Erro ao abrir a imagem do sistema de arquivos.");
         return EXIT_FAILURE;
     }
+    fs_lock(fs); // O shell só solta o sistema de arquivos enquanto espera um comando
+    fs->io_max = io_max;
+
+    if ((flags & FS_OPEN_URING) && !fs->uring) // O kernel pode não oferecer io_uring
+        print_error_with_message("io_uring indisponível; usando leituras síncronas.");
 
     uint32_t cwd = EXT2_ROOT_INO; // Diretório corrente
     char line[MAX_BUFFER_SHELL];
 
     while (1)
     {
-        char *pwd = fs_get_path(fs, cwd);        // Caminho atual
+        const char *pwd = fs_cwd_path(fs, cwd);  // Caminho atual
         printf("\033[1;34m[%s]\033[0m$> ", pwd); // [Diretório]$>
-        free(pwd);
         fflush(stdout); // Garante que o prompt seja exibido antes de ler a entrada
 
-        // Lê a linha de comando do usuário
-        if (fgets(line, sizeof(line), stdin) == NULL)
+        // Lê a linha de comando do usuário (o flusher pode gravar enquanto isso)
+        fs_unlock(fs);
+        char *read = fgets(line, sizeof(line), stdin);
+        fs_lock(fs);
+        if (read == NULL)
         {
             putchar('\n');
             break; /* EOF ou erro */
@@ -180,7 +264,10 @@ int main(int argc, char **argv)
             continue;
         }
 
+        fs_txn_begin(fs); // Cada comando é uma transação
         cmd->handler(argc_cmd, argvv, fs, &cwd);
+        if (fs_txn_commit(fs) < 0) // Grava as alterações do comando, conforme o modo de durabilidade
+            print_error_with_message("Erro ao gravar as alterações na imagem.");
     }
 
     // Fecha o sistema de arquivos
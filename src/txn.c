@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "utils.h"
+
+/**
+ * @file    txn.c
+ *
+ * Transações de metadados e log de escrita antecipada (WAL).
+ *
+ * Uma transação agrupa as alterações de um comando: inodes, blocos, bitmaps,
+ * descritores de grupo e superbloco ficam nas caches até fs_txn_commit, que
+ * os grava em um único lote ordenado (fs_sync). Com o log ativo, o lote é
+ * gravado antes no arquivo "<imagem>.wal" com uma única escrita e confirmado
+ * com fdatasync; só então os blocos são escritos na imagem e o log é zerado.
+ * Se o programa for interrompido no meio das escritas na imagem, o próximo
+ * fs_open reaplica o log. Um log incompleto (soma de verificação inválida)
+ * é descartado, pois nesse caso a imagem ainda não foi alterada.
+ *
+ * Formato do log: struct wal_header seguido de 'count' registros, cada um
+ * formado por struct wal_record e 'len' bytes a escrever no offset 'off'.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define WAL_MAGIC 0x4c415745u // "EWAL"
+
+struct wal_header // Cabeçalho do log
+{
+    uint32_t magic; // WAL_MAGIC se houver um lote confirmado
+    uint32_t count; // Número de registros
+    uint64_t bytes; // Bytes dos registros após o cabeçalho
+    uint64_t sum;   // Soma de verificação (FNV-1a) dos registros
+};
+
+struct wal_record // Cabeçalho de um registro do log
+{
+    uint64_t off; // Offset na imagem
+    uint32_t len; // Bytes de dados que seguem o registro
+    uint32_t pad; // Alinhamento
+};
+
+/**
+ * @brief   Calcula a soma de verificação FNV-1a de 64 bits de um trecho.
+ */
+static uint64_t wal_sum(const uint8_t *p, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief   Escreve um trecho inteiro em um descritor, repetindo escritas curtas.
+ */
+static int wal_pwrite(int fd, const void *buf, size_t len, off_t off)
+{
+    const uint8_t *p = buf;
+    while (len)
+    {
+        ssize_t n = pwrite(fd, p, len, off);
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Reaplica na imagem o lote confirmado no log, se houver.
+ *
+ * @return  Retorna 0 em caso de sucesso (com ou sem lote) ou -1 em caso de erro.
+ */
+static int wal_replay(ext2_fs_t *fs)
+{
+    struct wal_header h;
+    if (pread(fs->wal_fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) || h.magic != WAL_MAGIC)
+        return 0; // Log vazio ou zerado
+
+    struct stat st;
+    if (fstat(fs->wal_fd, &st) < 0)
+        return -1;
+    if (h.bytes > (uint64_t)st.st_size - sizeof(h)) // Cabeçalho incompleto ou corrompido: o lote não cabe no log
+        return 0;
+
+    uint8_t *data = malloc(h.bytes ? h.bytes : 1);
+    if (!data)
+        return -1;
+    if (pread(fs->wal_fd, data, h.bytes, sizeof(h)) != (ssize_t)h.bytes || wal_sum(data, h.bytes) != h.sum)
+    {
+        free(data); // Lote incompleto: a imagem ainda não foi alterada
+        return 0;
+    }
+
+    uint64_t pos = 0;
+    for (uint32_t i = 0; i < h.count; ++i)
+    {
+        struct wal_record r;
+        if (h.bytes - pos < sizeof(r))
+            break;
+        memcpy(&r, data + pos, sizeof(r));
+        pos += sizeof(r);
+        if (h.bytes - pos < r.len)
+            break;
+        if (wal_pwrite(fs->fd, data + pos, r.len, (off_t)r.off) < 0)
+        {
+            free(data);
+            return -1;
+        }
+        pos += r.len;
+    }
+    free(data);
+    return fdatasync(fs->fd); // Imagem atualizada antes de zerar o log
+}
+
+/**
+ * @brief   Abre (ou cria) o log "<imagem>.wal" e reaplica o lote pendente.
+ *
+ * Deve ser chamada antes de qualquer leitura da imagem.
+ *
+ * @param   fs        Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   img_path  Caminho da imagem.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_wal_open(ext2_fs_t *fs, const char *img_path)
+{
+    size_t len = strlen(img_path);
+    char *path = malloc(len + sizeof(".wal"));
+    if (!path)
+        return -1;
+    memcpy(path, img_path, len);
+    memcpy(path + len, ".wal", sizeof(".wal"));
+
+    fs->wal_fd = open(path, O_RDWR | O_CREAT, 0644);
+    free(path);
+    if (fs->wal_fd < 0)
+        return -1;
+
+    if (wal_replay(fs) < 0 || fs_wal_clear(fs) < 0)
+    {
+        fs_wal_close(fs);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Fecha o log (o lote pendente já deve ter sido gravado por fs_sync).
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_wal_close(ext2_fs_t *fs)
+{
+    if (fs->wal_fd >= 0)
+        close(fs->wal_fd);
+    fs->wal_fd = -1;
+}
+
+/**
+ * @brief   Grava no log tudo o que fs_sync vai escrever na imagem.
+ *
+ * O lote reúne os blocos sujos da cache, os descritores de grupo alterados e
+ * o superbloco (se alterado), é escrito com uma única chamada e confirmado
+ * com fdatasync. Deve ser chamada depois de fs_icache_flush.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Número de registros gravados (0 se não havia nada pendente) ou -1 em caso de erro.
+ */
+int fs_wal_write(ext2_fs_t *fs)
+{
+    fs_bcache_t *bc = &fs->bcache;
+
+    uint64_t bytes = 0; // Tamanho do lote
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < bc->used; ++i)
+        if (bc->bufs[i].dirty)
+        {
+            bytes += sizeof(struct wal_record) + fs->block_size;
+            count++;
+        }
+    for (uint32_t g = 0; g < fs->groups_count; ++g)
+        if (fs->gdt_dirty[g])
+        {
+            bytes += sizeof(struct wal_record) + sizeof(struct ext2_group_desc);
+            count++;
+        }
+    if (fs->sb_dirty)
+    {
+        bytes += sizeof(struct wal_record) + sizeof(fs->sb);
+        count++;
+    }
+    if (!count)
+        return 0;
+
+    uint8_t *buf = malloc(sizeof(struct wal_header) + bytes);
+    if (!buf)
+        return -1;
+
+    uint8_t *p = buf + sizeof(struct wal_header);
+    for (uint32_t i = 0; i < bc->used; ++i) // Monta os registros
+        if (bc->bufs[i].dirty)
+        {
+            struct wal_record r = {(uint64_t)fs_block_offset(fs, bc->bufs[i].block), fs->block_size, 0};
+            memcpy(p, &r, sizeof(r));
+            memcpy(p + sizeof(r), bc->bufs[i].data, fs->block_size);
+            p += sizeof(r) + fs->block_size;
+        }
+    for (uint32_t g = 0; g < fs->groups_count; ++g)
+        if (fs->gdt_dirty[g])
+        {
+            struct wal_record r = {(uint64_t)gd_offset(fs, g), sizeof(struct ext2_group_desc), 0};
+            memcpy(p, &r, sizeof(r));
+            memcpy(p + sizeof(r), &fs->gdt[g], sizeof(struct ext2_group_desc));
+            p += sizeof(r) + sizeof(struct ext2_group_desc);
+        }
+    if (fs->sb_dirty)
+    {
+        struct wal_record r = {EXT2_SUPER_OFFSET, sizeof(fs->sb), 0};
+        memcpy(p, &r, sizeof(r));
+        memcpy(p + sizeof(r), &fs->sb, sizeof(fs->sb));
+    }
+
+    struct wal_header h = {WAL_MAGIC, count, bytes, wal_sum(buf + sizeof(h), bytes)};
+    memcpy(buf, &h, sizeof(h));
+    int ret = wal_pwrite(fs->wal_fd, buf, sizeof(h) + bytes, 0);
+    free(buf);
+    if (ret < 0 || fdatasync(fs->wal_fd) < 0)
+        return -1;
+    return (int)count;
+}
+
+/**
+ * @brief   Zera o log depois que o lote chegou à imagem.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_wal_clear(ext2_fs_t *fs)
+{
+    if (ftruncate(fs->wal_fd, 0) < 0)
+        return -1;
+    return fdatasync(fs->wal_fd);
+}
+
+/**
+ * @brief   Inicia uma transação de metadados.
+ *
+ * Transações podem ser aninhadas; apenas o fs_txn_commit mais externo grava.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_txn_begin(ext2_fs_t *fs)
+{
+    fs->txn_depth++;
+}
+
+/**
+ * @brief   Confirma uma transação de metadados.
+ *
+ * Ao confirmar a transação mais externa, grava as alterações com fs_sync
+ * (passando pelo log, se ativo) quando o modo de durabilidade não for
+ * FS_DURABILITY_NONE ou quando o log estiver ativo; caso contrário, elas
+ * ficam em memória até o sync ou o fechamento.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro na escrita.
+ */
+int fs_txn_commit(ext2_fs_t *fs)
+{
+    if (!fs->txn_depth || --fs->txn_depth) // Fora de transação ou transação aninhada
+        return 0;
+    if (fs->durability == FS_DURABILITY_NONE && fs->wal_fd < 0)
+        return 0;
+    return fs_sync(fs);
+}
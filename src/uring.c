@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "utils.h"
+
+/**
+ * @file    uring.c
+ *
+ * Backend de leitura em lote com io_uring, usando as chamadas de sistema
+ * diretamente (sem liburing).
+ *
+ * Um lote de leituras é colocado na fila de submissão de uma só vez e as
+ * conclusões são coletadas fora de ordem, identificadas pelo campo user_data.
+ * Cada pedido lê uma sequência de blocos fisicamente contíguos, de modo que um
+ * arquivo fragmentado é lido com uma única chamada io_uring_enter por lote.
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+struct fs_uring // Anel do io_uring mapeado em memória
+{
+    int fd;                    // Descritor do io_uring
+    unsigned sq_entries;       // Número de entradas da fila de submissão
+    void *sq_ring;             // Mapeamento do anel de submissão
+    size_t sq_ring_size;       // Tamanho do mapeamento do anel de submissão
+    void *cq_ring;             // Mapeamento do anel de conclusão (pode ser o mesmo do de submissão)
+    size_t cq_ring_size;       // Tamanho do mapeamento do anel de conclusão
+    struct io_uring_sqe *sqes; // Vetor de entradas de submissão
+    size_t sqes_size;          // Tamanho do mapeamento das entradas de submissão
+    unsigned *sq_tail;         // Cauda da fila de submissão
+    unsigned *sq_mask;         // Máscara de índice da fila de submissão
+    unsigned *sq_array;        // Vetor de índices da fila de submissão
+    unsigned *cq_head;         // Cabeça da fila de conclusão
+    unsigned *cq_tail;         // Cauda da fila de conclusão
+    unsigned *cq_mask;         // Máscara de índice da fila de conclusão
+    struct io_uring_cqe *cqes; // Vetor de entradas de conclusão
+};
+
+/**
+ * @brief   Libera os mapeamentos e o descritor de um anel.
+ */
+static void uring_free(struct fs_uring *r)
+{
+    if (r->sqes && r->sqes != MAP_FAILED)
+        munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring && r->cq_ring != MAP_FAILED && r->cq_ring != r->sq_ring)
+        munmap(r->cq_ring, r->cq_ring_size);
+    if (r->sq_ring && r->sq_ring != MAP_FAILED)
+        munmap(r->sq_ring, r->sq_ring_size);
+    if (r->fd >= 0)
+        close(r->fd);
+    free(r);
+}
+
+/**
+ * @brief   Cria o anel do io_uring usado pelo sistema de arquivos.
+ *
+ * @param   fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   entries  Número de entradas da fila de submissão.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 se o io_uring não estiver disponível.
+ */
+int fs_uring_init(ext2_fs_t *fs, unsigned entries)
+{
+    struct fs_uring *r = calloc(1, sizeof(*r));
+    if (!r)
+        return -1;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0)
+    {
+        free(r);
+        return -1;
+    }
+
+    r->sq_entries = p.sq_entries;
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) // Os dois anéis compartilham o mesmo mapeamento
+    {
+        if (r->cq_ring_size > r->sq_ring_size)
+            r->sq_ring_size = r->cq_ring_size;
+        r->cq_ring_size = r->sq_ring_size;
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED)
+    {
+        uring_free(r);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        r->cq_ring = r->sq_ring;
+    else
+        r->cq_ring = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->cq_ring == MAP_FAILED || r->sqes == MAP_FAILED)
+    {
+        uring_free(r);
+        return -1;
+    }
+
+    uint8_t *sq = r->sq_ring;
+    uint8_t *cq = r->cq_ring;
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    fs->uring = r;
+    return 0;
+}
+
+/**
+ * @brief   Libera o anel do io_uring, se existir.
+ *
+ * @param   fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_uring_destroy(ext2_fs_t *fs)
+{
+    if (!fs->uring)
+        return;
+    uring_free(fs->uring);
+    fs->uring = NULL;
+}
+
+/**
+ * @brief   Lê um lote de sequências de blocos da imagem com io_uring.
+ *
+ * As leituras são submetidas em grupos de até sq_entries e as conclusões são
+ * consumidas na ordem em que chegam. Leituras curtas são tratadas como erro.
+ *
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   runs    Sequências de blocos a serem lidas (sem buracos).
+ * @param   bufs    Buffers de destino (run->len blocos cada), na mesma ordem de 'runs'.
+ * @param   count   Número de sequências do lote.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_uring_read_runs(ext2_fs_t *fs, const struct fs_block_run *runs, uint8_t *const *bufs, uint32_t count)
+{
+    struct fs_uring *r = fs->uring;
+    int ret = 0;
+    uint32_t done = 0;
+    while (done < count)
+    {
+        uint32_t n = count - done;
+        if (n > r->sq_entries)
+            n = r->sq_entries;
+
+        unsigned tail = *r->sq_tail; // Só este processo escreve na cauda
+        for (uint32_t i = 0; i < n; ++i, ++tail)
+        {
+            unsigned idx = tail & *r->sq_mask;
+            struct io_uring_sqe *sqe = &r->sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fs->fd;
+            sqe->addr = (uint64_t)(uintptr_t)bufs[done + i];
+            sqe->len = runs[done + i].len * fs->block_size;
+            sqe->off = (uint64_t)fs_block_offset(fs, runs[done + i].physical);
+            sqe->user_data = done + i; // Identifica o pedido (cada um já tem seu próprio buffer)
+            r->sq_array[idx] = idx;
+        }
+        __atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE); // Publica os pedidos para o kernel
+
+        uint32_t pending = n;
+        uint32_t to_submit = n;
+        while (pending)
+        {
+            int rc = (int)syscall(__NR_io_uring_enter, r->fd, to_submit, pending, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (rc < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return -1; // Anel em estado indefinido: os pedidos não foram consumidos
+            }
+            to_submit -= (uint32_t)rc; // Pedidos consumidos pelo kernel nesta chamada
+
+            unsigned head = *r->cq_head;
+            unsigned ctail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != ctail && pending; ++head, --pending) // Conclusões chegam em qualquer ordem
+            {
+                struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+                if (cqe->res < 0 || (uint32_t)cqe->res != runs[cqe->user_data].len * fs->block_size)
+                    ret = -1;
+            }
+            __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE); // Libera as entradas consumidas
+        }
+        done += n;
+    }
+    return ret;
+}
@@ -1,19 +1,35 @@
+#define _GNU_SOURCE // copy_file_range
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
+#include <errno.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 #include "utils.h"
 
 /**
  * @brief   Abre uma imagem de sistema de arquivos EXT2.
  *
  * Esta função abre a imagem do sistema de arquivos especificada por 'img_path',
- * lê o superbloco e inicializa a estrutura ext2_fs_t.
+ * escolhe o backend de E/S, lê o superbloco e inicializa a estrutura ext2_fs_t.
+ * Com FS_OPEN_RAM, a imagem inteira é carregada em memória; com FS_OPEN_MMAP, ela
+ * é mapeada em memória. Nos dois casos os blocos são acessados diretamente em
+ * memória; sem eles, o backend file usa pread/pwrite com a cache de blocos.
+ * Com FS_OPEN_URING, as leituras em lote (fs_read_runs) usam io_uring; se ele não
+ * estiver disponível, a imagem é aberta normalmente e fs->uring fica NULL.
+ * FS_OPEN_SYNC_COMMAND e FS_OPEN_SYNC_STRICT escolhem o modo de durabilidade
+ * (veja fs_txn_commit); sem eles, nada é sincronizado com o disco (fsync).
+ * Com FS_OPEN_WAL (apenas no backend file), as gravações passam antes pelo
+ * log "<imagem>.wal", e um lote interrompido é reaplicado aqui. Com
+ * FS_OPEN_FLUSHER, os blocos sujos são gravados em segundo plano (flusher.c);
+ * nesse caso o chamador deve usar fs_lock/fs_unlock ao acessar a imagem.
  *
  * @param img_path Caminho para a imagem do sistema de arquivos EXT2.
+ * @param flags    Modos de abertura (FS_OPEN_*), ou 0 para o acesso padrão.
  * @return Ponteiro para a estrutura ext2_fs_t ou NULL em caso de erro.
  */
-ext2_fs_t *fs_open(char *img_path)
+ext2_fs_t *fs_open(char *img_path, int flags)
 {
     // Abre o arquivo da imagem para leitura e escrita binária
     FILE *fp = fopen(img_path, "rb+");
@@ -27,34 +43,106 @@ ext2_fs_t *fs_open(char *img_path)
         return NULL;
     }
 
-    // Lê o superbloco a partir do offset 1024 bytes
-    if (fseek(fp, EXT2_SUPER_OFFSET, SEEK_SET) != 0)
+    // Salva descritor de arquivo
+    fs->fd = fileno(fp);
+    fs->wal_fd = -1;
+    fs->io_max = FS_IO_MAX_DEFAULT;
+
+    // Escolhe o modo de durabilidade
+    if (flags & FS_OPEN_SYNC_STRICT)
+        fs->durability = FS_DURABILITY_STRICT;
+    else if (flags & FS_OPEN_SYNC_COMMAND)
+        fs->durability = FS_DURABILITY_COMMAND;
+    else
+        fs->durability = FS_DURABILITY_NONE;
+
+    // Abre o log e reaplica um lote interrompido, antes de ler qualquer coisa da imagem
+    if ((flags & FS_OPEN_WAL) && ((flags & (FS_OPEN_MMAP | FS_OPEN_RAM)) || fs_wal_open(fs, img_path) < 0))
+    {
+        free(fs);
+        fclose(fp);
+        return NULL;
+    }
+
+    // Escolhe o backend de E/S
+    if (flags & FS_OPEN_RAM)
+        fs->io = &fs_io_ram;
+    else if (flags & FS_OPEN_MMAP)
+        fs->io = &fs_io_mmap;
+    else
+        fs->io = &fs_io_file;
+    if (fs->io->open(fs) < 0)
     {
+        fs_wal_close(fs);
         free(fs);
         fclose(fp);
         return NULL;
     }
-    size_t sb_read = fread(&fs->sb, 1, sizeof(fs->sb), fp);
-    if (sb_read != sizeof(fs->sb))
+
+    // Lê o superbloco a partir do offset 1024 bytes e verifica a assinatura mágica
+    if (fs->io->read_range(fs, &fs->sb, sizeof(fs->sb), EXT2_SUPER_OFFSET) < 0 || fs->sb.s_magic != EXT2_SUPER_MAGIC)
     {
+        fs->io->close(fs);
+        fs_wal_close(fs);
         free(fs);
         fclose(fp);
         return NULL;
     }
 
-    // Verifica assinatura mágica
-    if (fs->sb.s_magic != EXT2_SUPER_MAGIC)
+    // Obtém o tamanho do bloco do superbloco (de 1 KiB até EXT2_MAX_BLOCK_SIZE)
+    if (fs->sb.s_log_block_size > 10 || (EXT2_MIN_BLOCK_SIZE << fs->sb.s_log_block_size) > EXT2_MAX_BLOCK_SIZE)
     {
+        fs->io->close(fs);
+        fs_wal_close(fs);
         free(fs);
         fclose(fp);
         return NULL;
     }
+    fs->block_size = EXT2_MIN_BLOCK_SIZE << fs->sb.s_log_block_size;
+    fs->ptrs_per_block = fs->block_size / sizeof(uint32_t);
 
     // Calcula número de grupos de blocos
     fs->groups_count = (fs->sb.s_blocks_count + fs->sb.s_blocks_per_group - 1) / fs->sb.s_blocks_per_group;
 
-    // Salva descritor de arquivo
-    fs->fd = fileno(fp);
+    // Carrega toda a tabela de descritores de grupo em memória
+    size_t gdt_size = fs->groups_count * sizeof(struct ext2_group_desc);
+    fs->gdt = malloc(gdt_size);
+    fs->gdt_dirty = calloc(fs->groups_count, 1);
+    if (!fs->gdt || !fs->gdt_dirty || fs->io->read_range(fs, fs->gdt, gdt_size, gd_offset(fs, 0)) < 0)
+    {
+        fs->io->close(fs);
+        free(fs->gdt);
+        free(fs->gdt_dirty);
+        fs_wal_close(fs);
+        free(fs);
+        fclose(fp);
+        return NULL;
+    }
+
+    // Cria o anel do io_uring, se solicitado (sem ele, as leituras em lote usam a cache de blocos)
+    if (flags & FS_OPEN_URING)
+        fs_uring_init(fs, FS_URING_ENTRIES);
+
+    // Inicializa as caches de blocos, de inodes e de entradas de diretório e o índice de espaço livre
+    if (fs_bcache_init(fs, BCACHE_DEFAULT_BLOCKS) < 0 || fs_icache_init(fs, ICACHE_DEFAULT_INODES) < 0 ||
+        fs_dcache_init(fs, DCACHE_DEFAULT_ENTRIES) < 0 || fs_freeidx_init(fs) < 0)
+    {
+        fs_dcache_destroy(fs);
+        fs_icache_destroy(fs);
+        fs_bcache_destroy(fs);
+        fs_uring_destroy(fs);
+        fs->io->close(fs);
+        free(fs->gdt);
+        free(fs->gdt_dirty);
+        fs_wal_close(fs);
+        free(fs);
+        fclose(fp);
+        return NULL;
+    }
+
+    // Cria o flusher, se solicitado e útil (sem ele, os blocos sujos são gravados no sync e ao fechar)
+    if ((flags & FS_OPEN_FLUSHER) && fs->io == &fs_io_file && fs->durability == FS_DURABILITY_NONE && fs->wal_fd < 0)
+        fs_flusher_start(fs);
 
     return fs;
 }
@@ -62,8 +150,9 @@ ext2_fs_t *fs_open(char *img_path)
 /**
  * @brief   Fecha uma imagem de sistema de arquivos EXT2.
  *
- * Esta função sincroniza o superbloco, fecha o descritor de arquivo
- * e libera a memória alocada para a estrutura ext2_fs_t.
+ * Esta função escreve os blocos sujos da cache, sincroniza o superbloco,
+ * libera o backend de E/S, fecha o descritor de arquivo e libera a memória
+ * alocada para a estrutura ext2_fs_t.
  *
  * @param   fs  Ponteiro para a estrutura ext2_fs_t a ser fechada.
  * @return  Nenhum valor é retornado.
@@ -72,8 +161,19 @@ void fs_close(ext2_fs_t *fs)
 {
     if (!fs)
         return;
-    fs_sync_super(fs);
+    fs_flusher_stop(fs); // Encerra o flusher (chamada com o lock, se ele estiver ativo)
+    fs_sync(fs);
+    fs_cwd_invalidate(fs);
+    fs_freeidx_destroy(fs);
+    fs_dcache_destroy(fs);
+    fs_icache_destroy(fs);
+    fs_bcache_destroy(fs);
+    fs_uring_destroy(fs);
+    fs->io->close(fs);
+    fs_wal_close(fs);
     close(fs->fd);
+    free(fs->gdt);
+    free(fs->gdt_dirty);
     free(fs);
 }
 
@@ -87,14 +187,35 @@ void fs_close(ext2_fs_t *fs)
  */
 off_t fs_block_offset(ext2_fs_t *fs, uint32_t block)
 {
-    (void)fs;
-    return (off_t)block * EXT2_BLOCK_SIZE; // Calcula o deslocamento do bloco
+    return (off_t)block * fs->block_size; // Calcula o deslocamento do bloco
+}
+
+/**
+ * @brief   Obtém um ponteiro para um bloco dentro da imagem em memória.
+ *
+ * Só está disponível com os backends mmap e ram. O ponteiro permanece válido
+ * até fs_close; quem alterar o bloco por ele deve chamar fs_io_dirty, e as
+ * alterações são gravadas na imagem no próximo fs_sync (ou fs_close).
+ *
+ * @param   fs      Ponteiro para a estrutura ext2_fs_t.
+ * @param   block   Número do bloco.
+ *
+ * @return  Ponteiro para o bloco ou NULL se a imagem não estiver em memória ou o bloco estiver fora dela.
+ */
+void *fs_block_ptr(ext2_fs_t *fs, uint32_t block)
+{
+    off_t off = fs_block_offset(fs, block);
+    if (!fs->map || (size_t)off + fs->block_size > fs->map_size)
+        return NULL;
+    return fs->map + off;
 }
 
 /**
  * @brief   Lê um bloco de dados do sistema de arquivos EXT2.
  *
- * Esta função lê um bloco de dados da imagem do sistema de arquivos e armazena os dados no buffer fornecido.
+ * Esta função copia um bloco de dados para o buffer fornecido. O bloco é obtido
+ * da imagem em memória (backends mmap e ram) ou da cache de blocos, que só o lê
+ * da imagem quando não estiver em memória.
  *
  * @param   fs      Ponteiro para a estrutura ext2_fs_t.
  * @param   block   Número do bloco a ser lido.
@@ -104,16 +225,22 @@ off_t fs_block_offset(ext2_fs_t *fs, uint32_t block)
  */
 int fs_read_block(ext2_fs_t *fs, uint32_t block, void *buf)
 {
-    ssize_t bytes_read = pread(fs->fd, buf, EXT2_BLOCK_SIZE, fs_block_offset(fs, block)); // Lê o bloco
-    if (bytes_read == EXT2_BLOCK_SIZE)
-        return 0;
-    return -1;
+    if (fs->map) // Imagem em memória: copia direto dela
+        return fs->io->read_block(fs, block, buf);
+
+    struct fs_buf *b = fs_buf_get(fs, block, 1); // Obtém o bloco da cache
+    if (!b)
+        return -1;
+    memcpy(buf, b->data, fs->block_size);
+    return 0;
 }
 
 /**
  * @brief   Escreve um bloco de dados no sistema de arquivos EXT2.
  *
- * Esta função escreve um bloco de dados na imagem do sistema de arquivos.
+ * Esta função copia o buffer fornecido para a cache de blocos e marca o bloco
+ * como sujo. A escrita na imagem é adiada até o despejo do bloco ou fs_sync.
+ * Com a imagem em memória, o bloco é copiado direto para ela.
  *
  * @param   fs      Ponteiro para a estrutura ext2_fs_t.
  * @param   block   Número do bloco.
@@ -123,70 +250,244 @@ int fs_read_block(ext2_fs_t *fs, uint32_t block, void *buf)
  */
 int fs_write_block(ext2_fs_t *fs, uint32_t block, void *buf)
 {
-    ssize_t bytes_written = pwrite(fs->fd, buf, EXT2_BLOCK_SIZE, fs_block_offset(fs, block)); // Escreve o bloco
-    if (bytes_written == EXT2_BLOCK_SIZE)
-        return 0;
-    return -1;
+    if (fs->map) // Imagem em memória: grava nela (gravada na imagem em fs_sync)
+        return fs->io->write_block(fs, block, buf);
+
+    struct fs_buf *b = fs_buf_get(fs, block, 0); // Bloco será sobrescrito por inteiro
+    if (!b)
+        return -1;
+    memcpy(b->data, buf, fs->block_size);
+    fs_buf_dirty(fs, b);
+    return 0;
+}
+
+/**
+ * @brief   Lê sequências de blocos juntando com preadv as que estão próximas na imagem.
+ *
+ * Uma sequência entra na mesma leitura da anterior se começar no máximo
+ * FS_READ_GAP_BLOCKS blocos depois dela (os blocos do intervalo, em geral
+ * blocos indiretos, são lidos para um buffer descartado), até fs->io_max
+ * bytes por leitura. Sequências maiores que isso são divididas.
+ *
+ * @param   fs     Ponteiro para a estrutura ext2_fs_t.
+ * @param   runs   Sequências de blocos (sem buracos), na ordem de leitura.
+ * @param   dsts   Destino de cada sequência.
+ * @param   count  Número de sequências.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+static int read_runs_vec(ext2_fs_t *fs, const struct fs_block_run *runs, uint8_t *const *dsts, uint32_t count)
+{
+    uint32_t bs = fs->block_size;
+    uint32_t max = fs_io_max_blocks(fs);
+    uint8_t *gap_buf = malloc((size_t)FS_READ_GAP_BLOCKS * bs);
+    struct iovec *iov = malloc(FS_IOV_MAX * sizeof(*iov));
+    if (!gap_buf || !iov)
+    {
+        free(gap_buf);
+        free(iov);
+        return -1;
+    }
+
+    int ret = 0;
+    uint32_t i = 0, done = 0; // Sequência atual e blocos dela já lidos
+    while (i < count && ret == 0)
+    {
+        uint32_t start = runs[i].physical + done; // Primeiro bloco da leitura
+        uint32_t next = start;                   // Bloco seguinte ao último da leitura
+        int niov = 0;
+        while (i < count)
+        {
+            if (next != start) // Sequência seguinte: só entra se começar logo adiante
+            {
+                uint32_t gap = runs[i].physical - next;
+                if (runs[i].physical < next || gap > FS_READ_GAP_BLOCKS || next - start + gap >= max || niov + 2 > FS_IOV_MAX)
+                    break;
+                if (gap)
+                    iov[niov++] = (struct iovec){gap_buf, (size_t)gap * bs};
+                next += gap;
+            }
+            uint32_t n = runs[i].len - done; // Blocos da sequência que cabem na leitura
+            if (n > max - (next - start))
+                n = max - (next - start);
+            iov[niov++] = (struct iovec){dsts[i] + (size_t)done * bs, (size_t)n * bs};
+            next += n;
+            done += n;
+            if (done < runs[i].len) // Leitura cheia no meio da sequência
+                break;
+            i++;
+            done = 0;
+        }
+        ret = fs->io->read_vec(fs, iov, niov, fs_block_offset(fs, start));
+    }
+
+    free(gap_buf);
+    free(iov);
+    return ret;
+}
+
+/**
+ * @brief   Lê várias sequências de blocos de uma só vez para um buffer contíguo.
+ *
+ * Cada sequência fisicamente contígua é lida com uma única operação: todas no
+ * mesmo lote do io_uring, quando disponível, sequências próximas juntas em um
+ * preadv (read_runs_vec), se o backend oferecer read_vec, ou uma leitura por
+ * sequência pelo backend de E/S. Buracos (physical == 0) são preenchidos com zeros, e blocos
+ * sujos da cache de blocos são copiados por cima do que foi lido da imagem.
+ *
+ * @param   fs      Ponteiro para a estrutura ext2_fs_t.
+ * @param   runs    Sequências de blocos a serem lidas, na ordem do buffer.
+ * @param   count   Número de sequências.
+ * @param   buf     Buffer com espaço para a soma dos blocos de todas as sequências.
+ *
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
+ */
+int fs_read_runs(ext2_fs_t *fs, const struct fs_block_run *runs, uint32_t count, void *buf)
+{
+    struct fs_block_run *pending = malloc(count * sizeof(*pending)); // Sequências que precisam ser lidas da imagem
+    uint8_t **dsts = malloc(count * sizeof(uint8_t *));              // Destino de cada sequência pendente
+    if (!pending || !dsts)
+    {
+        free(pending);
+        free(dsts);
+        return -1;
+    }
+
+    uint8_t *dst = buf;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        size_t len = (size_t)runs[i].len * fs->block_size;
+        if (!runs[i].physical) // Buraco no arquivo
+            memset(dst, 0, len);
+        else
+        {
+            pending[n] = runs[i];
+            dsts[n++] = dst;
+        }
+        dst += len;
+    }
+
+    int ret = 0;
+    if (fs->uring && !fs->map && n) // Um único lote do io_uring para todas as sequências
+        ret = fs_uring_read_runs(fs, pending, dsts, n);
+    else if (fs->io->read_vec) // Sequências próximas na imagem lidas juntas
+        ret = read_runs_vec(fs, pending, dsts, n);
+    else // Uma leitura por sequência
+        for (uint32_t i = 0; i < n && ret == 0; ++i)
+            ret = fs->io->read_range(fs, dsts[i], (size_t)pending[i].len * fs->block_size, fs_block_offset(fs, pending[i].physical));
+
+    if (ret == 0 && fs->bcache.dirty) // Há blocos alterados na cache que ainda não foram escritos na imagem
+    {
+        for (uint32_t i = 0; i < n; ++i)
+            for (uint32_t j = 0; j < pending[i].len; ++j)
+            {
+                struct fs_buf *b = fs_buf_peek(fs, pending[i].physical + j);
+                if (b && b->dirty)
+                    memcpy(dsts[i] + (size_t)j * fs->block_size, b->data, fs->block_size);
+            }
+    }
+
+    free(pending);
+    free(dsts);
+    return ret;
 }
 
 /**
  * @brief Calcula o deslocamento (offset) do descritor de grupo no sistema de arquivos EXT2.
  *
  * Esta função retorna o deslocamento em bytes onde o descritor de grupo de número 'group'
- * está localizado dentro do sistema de arquivos EXT2. O cálculo considera o offset do superbloco,
- * o tamanho do bloco e o índice do grupo multiplicado pelo tamanho da estrutura de descritor de grupo.
+ * está localizado dentro do sistema de arquivos EXT2. A tabela de descritores começa no bloco
+ * seguinte ao do superbloco (s_first_data_block + 1), e o deslocamento é somado ao índice do
+ * grupo multiplicado pelo tamanho da estrutura de descritor de grupo.
  *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
  * @param group Número do grupo cujo offset do descritor será calculado.
  *
  * @return O deslocamento (offset) em bytes do descritor de grupo especificado.
  */
-off_t gd_offset(uint32_t group)
+off_t gd_offset(ext2_fs_t *fs, uint32_t group)
 {
-    off_t group_desc_table_offset = EXT2_SUPER_OFFSET + EXT2_BLOCK_SIZE;     // Offset do início da tabela de descritores de grupo
-    return group_desc_table_offset + group * sizeof(struct ext2_group_desc); // Calcula o offset do descritor de grupo
+    off_t group_desc_table_offset = fs_block_offset(fs, fs->sb.s_first_data_block + 1); // Offset do início da tabela de descritores de grupo
+    return group_desc_table_offset + group * sizeof(struct ext2_group_desc);            // Calcula o offset do descritor de grupo
 }
 
 /**
  * @brief Lê o descritor de grupo do sistema de arquivos EXT2.
  *
- * Esta função lê o descritor de grupo especificado pelo índice 'group' do sistema de arquivos EXT2
- * apontado por 'fs' e armazena o resultado na estrutura 'gd'. Utiliza a função pread para ler os
- * bytes correspondentes diretamente do arquivo de dispositivo ou imagem do sistema de arquivos.
+ * Esta função copia o descritor de grupo especificado pelo índice 'group' da tabela
+ * de descritores mantida em memória (carregada em fs_open) para a estrutura 'gd'.
+ * Nenhum acesso à imagem é feito.
  *
  * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
  * @param group Índice do grupo cujo descritor deve ser lido.
  * @param gd    Ponteiro para a estrutura onde o descritor de grupo lido será armazenado.
  *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na leitura.
+ * @return Retorna 0 em caso de sucesso, ou -1 se o grupo for inválido.
  */
 int fs_read_group_desc(ext2_fs_t *fs, uint32_t group, struct ext2_group_desc *gd)
 {
-    ssize_t bytes_read = pread(fs->fd, gd, sizeof(*gd), gd_offset(group)); // Lê o descritor de grupo
-    if (bytes_read == (ssize_t)sizeof(*gd))
-        return 0;
-    return -1;
+    if (group >= fs->groups_count)
+        return -1;
+    *gd = fs->gdt[group]; // Copia o descritor da tabela em memória
+    return 0;
 }
 
 /**
- * @brief   Escreve o descritor de grupo no disco para um grupo específico do sistema de arquivos ext2.
+ * @brief   Atualiza o descritor de um grupo específico do sistema de arquivos ext2.
  *
- * Esta função grava a estrutura de descritor de grupo fornecida (`gd`) no local apropriado do disco,
- * correspondente ao grupo identificado por `group`, usando o descritor de arquivo do sistema de arquivos (`fs->fd`).
- * Utiliza a função `pwrite` para garantir que a escrita ocorra no deslocamento correto, retornando 0 em caso de sucesso
- * ou -1 em caso de falha.
+ * Esta função copia a estrutura de descritor de grupo fornecida (`gd`) para a tabela
+ * em memória e marca o descritor como alterado. A escrita na imagem é feita em lote
+ * por fs_flush_group_descs.
  *
  * @param fs    Ponteiro para a estrutura do sistema de arquivos ext2.
  * @param group Índice do grupo cujo descritor será escrito.
  * @param gd    Ponteiro para a estrutura do descritor de grupo a ser gravada.
  *
- * @return Retorna 0 em caso de sucesso, -1 em caso de erro na escrita.
+ * @return Retorna 0 em caso de sucesso, -1 se o grupo for inválido.
  */
 int fs_write_group_desc(ext2_fs_t *fs, uint32_t group, struct ext2_group_desc *gd)
 {
-    ssize_t bytes_written = pwrite(fs->fd, gd, sizeof(*gd), gd_offset(group)); // Escreve o descritor de grupo
-    if (bytes_written == (ssize_t)sizeof(*gd))
-        return 0;
-    return -1;
+    if (group >= fs->groups_count)
+        return -1;
+    fs->gdt[group] = *gd;                                   // Atualiza a tabela em memória
+    fs->gdt_dirty[group] = 1;                               // Escrita adiada
+    fs_freeidx_update(fs, group, gd->bg_free_blocks_count); // Mantém o resumo do índice de espaço livre
+    return 0;
+}
+
+/**
+ * @brief   Escreve na imagem os descritores de grupo alterados.
+ *
+ * Descritores alterados e adjacentes na tabela são agrupados e escritos
+ * com uma única escrita por sequência.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos ext2.
+ *
+ * @return Retorna 0 em caso de sucesso, -1 em caso de erro na escrita.
+ */
+int fs_flush_group_descs(ext2_fs_t *fs)
+{
+    uint32_t group = 0;
+    while (group < fs->groups_count)
+    {
+        if (!fs->gdt_dirty[group])
+        {
+            group++;
+            continue;
+        }
+
+        uint32_t end = group; // Encontra o fim da sequência de descritores alterados
+        while (end < fs->groups_count && fs->gdt_dirty[end])
+            end++;
+
+        size_t len = (end - group) * sizeof(struct ext2_group_desc);
+        if (fs->io->write_range(fs, &fs->gdt[group], len, gd_offset(fs, group)) < 0)
+            return -1;
+        memset(&fs->gdt_dirty[group], 0, end - group);
+        group = end;
+    }
+    return 0;
 }
 
 /**
@@ -228,81 +529,126 @@ int inode_loc(ext2_fs_t *fs, uint32_t ino, struct ext2_group_desc *gd_out, off_t
 }
 
 /**
- * @brief   Lê um inode do sistema de arquivos EXT2.
+ * @brief   Escolhe o grupo de um novo arquivo: o grupo do diretório pai ou um próximo dele.
  *
- * Esta função lê o inode especificado por 'ino' e armazena os dados na estrutura 'inode'.
- * Utiliza a função pread para ler os bytes diretamente do arquivo de dispositivo ou imagem.
+ * Tenta o grupo do pai, depois grupos a distâncias 1, 2, 4, ... dele e, por
+ * fim, qualquer grupo com inodes livres, como no ext2.
  *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param ino   Número do inode a ser lido.
- * @param inode Ponteiro para a estrutura onde o inode lido será armazenado.
+ * @param fs            Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param parent_group  Grupo do diretório pai.
  *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na leitura.
+ * @return Número do grupo escolhido.
  */
-int fs_read_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode)
+static uint32_t find_group_other(ext2_fs_t *fs, uint32_t parent_group)
 {
-    struct ext2_group_desc group_desc;
-    off_t inode_offset;
+    uint32_t n = fs->groups_count;
+    struct ext2_group_desc *gdt = fs->gdt;
 
-    // Localiza o descritor de grupo e o offset do inode
-    if (inode_loc(fs, ino, &group_desc, &inode_offset) < 0)
-        return -1;
+    if (gdt[parent_group].bg_free_inodes_count && gdt[parent_group].bg_free_blocks_count)
+        return parent_group;
 
-    // Lê o inode do disco para a estrutura fornecida
-    ssize_t bytes_read = pread(fs->fd, inode, sizeof(*inode), inode_offset);
-    if (bytes_read != (ssize_t)sizeof(*inode))
-        return -1;
+    uint32_t group = parent_group;
+    for (uint32_t step = 1; step < n; step <<= 1) // Grupos cada vez mais distantes do pai
+    {
+        group = (group + step) % n;
+        if (gdt[group].bg_free_inodes_count && gdt[group].bg_free_blocks_count)
+            return group;
+    }
 
-    return 0;
+    for (uint32_t i = 1; i < n; ++i) // Qualquer grupo com inodes livres
+    {
+        group = (parent_group + i) % n;
+        if (gdt[group].bg_free_inodes_count)
+            return group;
+    }
+    return parent_group;
 }
 
 /**
- * @brief   Escreve um inode no sistema de arquivos EXT2.
+ * @brief   Escolhe o grupo de um novo diretório, no estilo Orlov.
  *
- * Esta função escreve os dados do inode especificado por 'ino' na imagem do sistema de arquivos.
- * Utiliza a função pwrite para escrever os bytes diretamente no arquivo de dispositivo ou imagem.
+ * Diretórios criados na raiz são espalhados: vão para o grupo com menos
+ * diretórios entre os que têm inodes e blocos livres acima da média.
+ * Os demais ficam no grupo do pai, ou no primeiro grupo seguinte, desde que
+ * o grupo não tenha diretórios demais nem esteja cheio demais.
  *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param ino   Número do inode a ser escrito.
- * @param inode Ponteiro para a estrutura contendo os dados do inode a serem escritos.
+ * @param fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param parent  Inode do diretório pai.
  *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na escrita.
+ * @return Número do grupo escolhido.
  */
-int fs_write_inode(ext2_fs_t *fs, uint32_t ino, struct ext2_inode *inode)
+static uint32_t find_group_orlov(ext2_fs_t *fs, uint32_t parent)
 {
-    struct ext2_group_desc group_desc;
-    off_t inode_offset;
-
-    // Localiza o descritor de grupo e o offset do inode
-    if (inode_loc(fs, ino, &group_desc, &inode_offset) < 0)
-        return -1;
+    uint32_t n = fs->groups_count;
+    struct ext2_group_desc *gdt = fs->gdt;
+    uint32_t parent_group = (parent - 1) / fs->sb.s_inodes_per_group;
+    uint32_t avefreei = fs->sb.s_free_inodes_count / n;
+    uint32_t avefreeb = fs->sb.s_free_blocks_count / n;
+    uint32_t ndirs = 0;
+    for (uint32_t g = 0; g < n; ++g)
+        ndirs += gdt[g].bg_used_dirs_count;
+
+    if (parent == EXT2_ROOT_INO) // Diretório de primeiro nível: espalha pelos grupos
+    {
+        uint32_t best = n;
+        for (uint32_t g = 0; g < n; ++g)
+        {
+            if (!gdt[g].bg_free_inodes_count || gdt[g].bg_free_inodes_count < avefreei || gdt[g].bg_free_blocks_count < avefreeb)
+                continue;
+            if (best == n || gdt[g].bg_used_dirs_count < gdt[best].bg_used_dirs_count)
+                best = g;
+        }
+        if (best < n)
+            return best;
+        return find_group_other(fs, parent_group);
+    }
 
-    // Escreve o inode no disco a partir da estrutura fornecida
-    ssize_t bytes_written = pwrite(fs->fd, inode, sizeof(*inode), inode_offset);
-    if (bytes_written != (ssize_t)sizeof(*inode))
-        return -1;
-    return 0;
+    uint32_t max_dirs = ndirs / n + fs->sb.s_inodes_per_group / 16; // Limites usados pelo Orlov do ext2
+    uint32_t min_inodes = avefreei > fs->sb.s_inodes_per_group / 4 ? avefreei - fs->sb.s_inodes_per_group / 4 : 1;
+    uint32_t min_blocks = avefreeb > fs->sb.s_blocks_per_group / 4 ? avefreeb - fs->sb.s_blocks_per_group / 4 : 1;
+    for (uint32_t i = 0; i < n; ++i) // Perto do pai, se o grupo não estiver sobrecarregado
+    {
+        uint32_t g = (parent_group + i) % n;
+        if (gdt[g].bg_used_dirs_count < max_dirs && gdt[g].bg_free_inodes_count >= min_inodes && gdt[g].bg_free_blocks_count >= min_blocks)
+            return g;
+    }
+    return find_group_other(fs, parent_group);
 }
 
 /**
  * @brief   Aloca um novo inode no sistema de arquivos EXT2.
  *
  * Esta função procura por um inode livre no sistema de arquivos e o aloca,
- * retornando o número do inode alocado em 'out_ino'.
+ * retornando o número do inode alocado em 'out_ino'. Arquivos são colocados
+ * no grupo do diretório pai (ou perto dele) e diretórios são distribuídos
+ * entre os grupos no estilo Orlov, para que o conteúdo de um diretório fique
+ * próximo dele na imagem.
  *
  * @param fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
  * @param mode     Modo do inode a ser alocado (por exemplo, diretório ou arquivo regular).
+ * @param parent   Inode do diretório pai (0 para alocar no primeiro grupo com inodes livres).
  * @param out_ino  Ponteiro onde o número do inode alocado será armazenado.
  *
  * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver inodes livres).
  */
-int fs_alloc_inode(ext2_fs_t *fs, uint16_t mode, uint32_t *out_ino)
+int fs_alloc_inode(ext2_fs_t *fs, uint16_t mode, uint32_t parent, uint32_t *out_ino)
 {
-    uint8_t bitmap[EXT2_BLOCK_SIZE];
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
 
-    // Percorre todos os grupos de blocos
-    for (uint32_t group = 0; group < fs->groups_count; ++group)
+    // Escolhe o grupo preferido a partir do pai
+    uint32_t first = 0;
+    if (parent && parent <= fs->sb.s_inodes_count)
     {
+        if ((mode & EXT2_S_IFDIR) == EXT2_S_IFDIR)
+            first = find_group_orlov(fs, parent);
+        else
+            first = find_group_other(fs, (parent - 1) / fs->sb.s_inodes_per_group);
+    }
+
+    // Percorre os grupos a partir do preferido
+    for (uint32_t i = 0; i < fs->groups_count; ++i)
+    {
+        uint32_t group = (first + i) % fs->groups_count;
         struct ext2_group_desc gd;
         if (fs_read_group_desc(fs, group, &gd) < 0)
             return -1;
@@ -315,30 +661,28 @@ int fs_alloc_inode(ext2_fs_t *fs, uint16_t mode, uint32_t *out_ino)
         if (fs_read_block(fs, gd.bg_inode_bitmap, bitmap) < 0)
             return -1;
 
-        // Procura por um inode livre no bitmap
-        for (uint32_t idx = 0; idx < fs->sb.s_inodes_per_group; ++idx)
-        {
-            if (!(bitmap[BIT_BYTE(idx)] & BIT_MASK(idx)))
-            {
-                // Marca o inode como usado
-                bitmap[BIT_BYTE(idx)] |= BIT_MASK(idx);
-                if (fs_write_block(fs, gd.bg_inode_bitmap, bitmap) < 0)
-                    return -1;
-
-                gd.bg_free_inodes_count--;
-                if ((mode & EXT2_S_IFDIR) == EXT2_S_IFDIR)
-                    gd.bg_used_dirs_count++;
-                if (fs_write_group_desc(fs, group, &gd) < 0)
-                    return -1;
-
-                fs->sb.s_free_inodes_count--;
-                fs_sync_super(fs);
-
-                // Calcula o número absoluto do inode (começa em 1)
-                *out_ino = group * fs->sb.s_inodes_per_group + idx + 1;
-                return 0;
-            }
-        }
+        // Procura por um inode livre no bitmap (uma palavra de 64 bits por vez)
+        uint32_t idx;
+        if (bitmap_find_clear(bitmap, fs->sb.s_inodes_per_group, 0, &idx) < 0)
+            continue;
+
+        // Marca o inode como usado
+        bitmap[BIT_BYTE(idx)] |= BIT_MASK(idx);
+        if (fs_write_block(fs, gd.bg_inode_bitmap, bitmap) < 0)
+            return -1;
+
+        gd.bg_free_inodes_count--;
+        if ((mode & EXT2_S_IFDIR) == EXT2_S_IFDIR)
+            gd.bg_used_dirs_count++;
+        if (fs_write_group_desc(fs, group, &gd) < 0)
+            return -1;
+
+        fs->sb.s_free_inodes_count--;
+        fs->sb_dirty = 1; // Superbloco escrito em fs_sync
+
+        // Calcula o número absoluto do inode (começa em 1)
+        *out_ino = group * fs->sb.s_inodes_per_group + idx + 1;
+        return 0;
     }
     return -1;
 }
@@ -358,12 +702,14 @@ int fs_free_inode(ext2_fs_t *fs, uint32_t ino)
     struct ext2_group_desc gd;
     off_t inode_offset;
 
+    fs_prealloc_release(fs, ino); // A janela de reserva do inode não será mais usada
+
     // Localiza o grupo e o offset do inode
     if (inode_loc(fs, ino, &gd, &inode_offset) < 0)
         return -1;
 
     // Lê o bitmap de inodes do grupo
-    uint8_t bitmap[EXT2_BLOCK_SIZE];
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
     if (fs_read_block(fs, gd.bg_inode_bitmap, bitmap) < 0)
         return -1;
 
@@ -385,189 +731,1070 @@ int fs_free_inode(ext2_fs_t *fs, uint32_t ino)
     gd.bg_free_inodes_count++;
     fs->sb.s_free_inodes_count++;
 
-    // Atualiza descritor de grupo e superbloco
+    // Atualiza descritor de grupo e superbloco (escritos em fs_sync)
     uint32_t group = (ino - 1) / fs->sb.s_inodes_per_group;
     if (fs_write_group_desc(fs, group, &gd) < 0)
         return -1;
+    fs->sb_dirty = 1;
+
+    return 0;
+}
+
+/**
+ * @brief   Imprime as informações de uma entrada de diretório.
+ *
+ * Esta função exibe o nome, inode, comprimento do registro, comprimento do nome
+ * e tipo de arquivo de uma entrada de diretório.
+ *
+ * @param e  Ponteiro para a entrada de diretório a ser impressa.
+ */
+void print_entry(struct ext2_dir_entry *e)
+{
+    char name[256];
+    size_t n = e->name_len < 255 ? e->name_len : 255;
+    memcpy(name, e->name, n);
+    name[n] = '\0';
+
+    if (e->file_type == 1)
+        printf("\033[32m%s\033[0m\n", name);
+    else if (e->file_type == 2)
+        printf("\033[34m%s\033[0m\n", name);
+
+    printf("inode: %u\n", e->inode);
+    printf("record length: %u\n", e->rec_len);
+    printf("name length: %u\n", e->name_len);
+    printf("file type: %u\n", e->file_type);
+    printf("\n");
+}
+
+/**
+ * @brief   Calcula o número de blocos de um grupo (o último grupo pode ser menor).
+ *
+ * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param group  Número do grupo.
+ *
+ * @return Número de blocos do grupo, que é também o número de bits válidos do seu bitmap de blocos.
+ */
+uint32_t fs_group_blocks(ext2_fs_t *fs, uint32_t group)
+{
+    uint32_t first = fs->sb.s_first_data_block + group * fs->sb.s_blocks_per_group; // Primeiro bloco do grupo
+    uint32_t left = fs->sb.s_blocks_count - first;
+    return left < fs->sb.s_blocks_per_group ? left : fs->sb.s_blocks_per_group;
+}
+
+/**
+ * @brief   Calcula o bloco preferido para um bloco lógico de um arquivo.
+ *
+ * O bloco preferido é o seguinte ao bloco físico do bloco lógico anterior
+ * (para que o arquivo fique contíguo) ou, se não houver, o início do grupo
+ * do inode (para que os dados fiquem perto do inode).
+ *
+ * @param fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param ino      Número do inode do arquivo.
+ * @param inode    Inode do arquivo (ou NULL se ainda não tiver blocos).
+ * @param logical  Bloco lógico que será alocado.
+ *
+ * @return Número do bloco preferido, para ser passado a fs_alloc_block/fs_alloc_blocks.
+ */
+uint32_t fs_block_goal(ext2_fs_t *fs, uint32_t ino, const struct ext2_inode *inode, uint32_t logical)
+{
+    if (inode && logical > 0 && logical <= 12 && inode->i_block[logical - 1]) // Logo após o bloco anterior (blocos diretos)
+        return inode->i_block[logical - 1] + 1;
+    if (!ino || ino > fs->sb.s_inodes_count)
+        return 0;
+    uint32_t group = (ino - 1) / fs->sb.s_inodes_per_group; // Início do grupo do inode
+    return fs->sb.s_first_data_block + group * fs->sb.s_blocks_per_group;
+}
+
+/**
+ * @brief   Procura em um grupo uma sequência de blocos livres, lendo seu descritor e seu bitmap.
+ *
+ * @param fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param group   Número do grupo.
+ * @param from    Bloco preferido dentro do grupo.
+ * @param want    Número de blocos desejado.
+ * @param gd      Recebe o descritor do grupo.
+ * @param bitmap  Recebe o bitmap de blocos do grupo.
+ * @param idx     Recebe o primeiro bloco da sequência (relativo ao grupo).
+ * @param len     Recebe o tamanho da sequência ('want' ou a maior sequência do grupo, se menor).
+ *
+ * @return Retorna 0 se encontrou blocos livres, 1 se o grupo está cheio ou -1 em caso de erro.
+ */
+static int group_find_run(ext2_fs_t *fs, uint32_t group, uint32_t from, uint32_t want, struct ext2_group_desc *gd, uint8_t *bitmap, uint32_t *idx, uint32_t *len)
+{
+    if (fs_read_group_desc(fs, group, gd) < 0 || fs_read_block(fs, gd->bg_block_bitmap, bitmap) < 0)
+        return -1;
+
+    if (fs_freeidx_find_run(fs, group, bitmap, from, want, idx, len) == 0)
+        return 0;
+    uint32_t pos = 0; // Índice indisponível: usa o bitmap, pulando as janelas de reserva
+    while (bitmap_find_clear(bitmap, fs_group_blocks(fs, group), pos, idx) == 0)
+    {
+        pos = fs_freeidx_skip_reserved(fs, group, *idx);
+        if (pos == *idx)
+        {
+            *len = 1;
+            return 0;
+        }
+    }
+    fs_freeidx_update(fs, group, 0); // Descritor e bitmap discordam: o grupo está cheio
+    return 1;
+}
+
+/**
+ * @brief   Escolhe uma sequência de blocos livres e não reservados para fs_alloc_blocks e fs_reserve_blocks.
+ *
+ * A sequência tem 'want' blocos e fica o mais perto possível do bloco 'goal'
+ * (no grupo dele ou no primeiro grupo seguinte que os tenha) ou, se nenhum
+ * grupo tiver uma sequência desse tamanho, é a maior sequência livre
+ * disponível. O grupo e os blocos são escolhidos pelo índice de espaço livre.
+ * Uma sequência nunca atravessa grupos.
+ *
+ * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param goal       Bloco preferido (0 para começar pelo primeiro grupo).
+ * @param want       Número de blocos desejado.
+ * @param out_group  Recebe o grupo da sequência.
+ * @param gd         Recebe o descritor do grupo.
+ * @param bitmap     Recebe o bitmap de blocos do grupo.
+ * @param out_idx    Recebe o primeiro bloco da sequência (relativo ao grupo).
+ * @param out_len    Recebe o tamanho da sequência (entre 1 e 'want').
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver blocos livres).
+ */
+static int find_free_run(ext2_fs_t *fs, uint32_t goal, uint32_t want, uint32_t *out_group, struct ext2_group_desc *gd, uint8_t *bitmap, uint32_t *out_idx, uint32_t *out_len)
+{
+    uint32_t group, idx = 0, len = 0;
+    uint32_t best_group = 0, best_len = 0; // Maior sequência encontrada, caso nenhuma tenha 'want' blocos
+    int found = 0;
+
+    if (!want)
+        return -1;
+    if (want > fs->sb.s_blocks_per_group)
+        want = fs->sb.s_blocks_per_group;
+
+    uint32_t goal_group = 0, goal_idx = 0; // Grupo e posição do bloco preferido
+    if (goal >= fs->sb.s_first_data_block && goal < fs->sb.s_blocks_count)
+    {
+        goal_group = (goal - fs->sb.s_first_data_block) / fs->sb.s_blocks_per_group;
+        goal_idx = (goal - fs->sb.s_first_data_block) % fs->sb.s_blocks_per_group;
+    }
+
+    // Primeiro grupo, a partir do grupo preferido e dando a volta, que tenha uma sequência de 'want' blocos
+    for (int wrap = 0; wrap < 2 && !found; ++wrap)
+    {
+        uint32_t start = wrap ? 0 : goal_group;
+        while (!found && fs_freeidx_find_group(fs, start, want, &group) == 0 && (!wrap || group < goal_group))
+        {
+            int r = group_find_run(fs, group, group == goal_group ? goal_idx : 0, want, gd, bitmap, &idx, &len);
+            if (r < 0)
+                return -1;
+            if (r == 0 && len == want)
+                found = 1;
+            else if (r == 0 && len > best_len)
+            {
+                best_group = group;
+                best_len = len;
+            }
+            start = group + 1;
+        }
+    }
+
+    // Nenhum grupo tem a sequência inteira: procura a maior sequência nos grupos que ainda não foram vistos
+    for (uint32_t start = 0; !found && fs_freeidx_find_group(fs, start, best_len + 1, &group) == 0; start = group + 1)
+    {
+        if (fs_freeidx_avail(fs, group) >= want) // Já visitado acima
+            continue;
+        int r = group_find_run(fs, group, 0, want, gd, bitmap, &idx, &len);
+        if (r < 0)
+            return -1;
+        if (r == 0 && len > best_len)
+        {
+            best_group = group;
+            best_len = len;
+        }
+    }
+    if (!found)
+    {
+        if (!best_len || group_find_run(fs, best_group, 0, best_len, gd, bitmap, &idx, &len) != 0)
+            return -1;
+        group = best_group;
+    }
+
+    *out_group = group;
+    *out_idx = idx;
+    *out_len = len;
+    return 0;
+}
+
+/**
+ * @brief   Aloca uma sequência de blocos contíguos no sistema de arquivos EXT2.
+ *
+ * Esta função aloca 'want' blocos consecutivos o mais perto possível do
+ * bloco 'goal' ou, se não houver, a maior sequência livre disponível
+ * (escolhida por find_free_run, fora das janelas de reserva). A alocação faz
+ * uma única alteração no bitmap, no descritor de grupo e no superbloco.
+ *
+ * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param goal       Bloco preferido (0 para começar pelo primeiro grupo), por exemplo de fs_block_goal.
+ * @param want       Número de blocos desejado.
+ * @param out_block  Ponteiro onde o primeiro bloco alocado será armazenado.
+ * @param out_len    Ponteiro onde o número de blocos alocados será armazenado (entre 1 e 'want').
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver blocos livres).
+ */
+int fs_alloc_blocks(ext2_fs_t *fs, uint32_t goal, uint32_t want, uint32_t *out_block, uint32_t *out_len)
+{
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    struct ext2_group_desc gd;
+    uint32_t group, idx, len;
+    if (find_free_run(fs, goal, want, &group, &gd, bitmap, &idx, &len) < 0)
+        return -1;
+
+    // Marca os blocos como usados com uma única escrita do bitmap
+    bitmap_set_run(bitmap, idx, len);
+    if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0)
+        return -1;
+    fs_freeidx_take(fs, group, idx, len);
+
+    gd.bg_free_blocks_count -= len;
+    if (fs_write_group_desc(fs, group, &gd) < 0)
+        return -1;
+
+    fs->sb.s_free_blocks_count -= len;
+    fs->sb_dirty = 1; // Superbloco escrito em fs_sync
+
+    // Calcula o número absoluto do primeiro bloco
+    *out_block = fs->sb.s_first_data_block + group * fs->sb.s_blocks_per_group + idx;
+    *out_len = len;
+    return 0;
+}
+
+/**
+ * @brief   Reserva uma sequência de blocos contíguos sem alocá-los.
+ *
+ * A sequência é escolhida como em fs_alloc_blocks, mas fica só no índice de
+ * espaço livre: o bitmap, o descritor de grupo e o superbloco não mudam, e as
+ * outras alocações deixam de usar esses blocos. Cada bloco é alocado depois
+ * com fs_alloc_reserved, e os que sobrarem são devolvidos com fs_unreserve_blocks.
+ *
+ * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param goal       Bloco preferido (0 para começar pelo primeiro grupo).
+ * @param want       Número de blocos desejado.
+ * @param out_block  Ponteiro onde o primeiro bloco reservado será armazenado.
+ * @param out_len    Ponteiro onde o número de blocos reservados será armazenado (entre 1 e 'want').
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver blocos livres).
+ */
+int fs_reserve_blocks(ext2_fs_t *fs, uint32_t goal, uint32_t want, uint32_t *out_block, uint32_t *out_len)
+{
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    struct ext2_group_desc gd;
+    uint32_t group, idx, len;
+    if (find_free_run(fs, goal, want, &group, &gd, bitmap, &idx, &len) < 0 || fs_freeidx_reserve(fs, group, idx, len) < 0)
+        return -1;
+
+    *out_block = fs->sb.s_first_data_block + group * fs->sb.s_blocks_per_group + idx;
+    *out_len = len;
+    return 0;
+}
+
+/**
+ * @brief   Aloca um bloco reservado com fs_reserve_blocks (o primeiro ou o último de sua janela).
+ *
+ * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param block  Número do bloco.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se o bloco não estiver reservado e livre).
+ */
+int fs_alloc_reserved(ext2_fs_t *fs, uint32_t block)
+{
+    if (block < fs->sb.s_first_data_block || block >= fs->sb.s_blocks_count)
+        return -1;
+    uint32_t rel = block - fs->sb.s_first_data_block;
+    uint32_t group = rel / fs->sb.s_blocks_per_group;
+    uint32_t idx = rel % fs->sb.s_blocks_per_group;
+
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    struct ext2_group_desc gd;
+    if (fs_read_group_desc(fs, group, &gd) < 0 || fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0)
+        return -1;
+    if (bitmap[BIT_BYTE(idx)] & BIT_MASK(idx)) // Bloco já usado: a janela não vale mais
+        return -1;
+    if (fs_freeidx_unreserve(fs, group, idx, 1) < 0)
+        return -1;
+
+    bitmap[BIT_BYTE(idx)] |= BIT_MASK(idx);
+    if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0)
+        return -1;
+    gd.bg_free_blocks_count--;
+    if (fs_write_group_desc(fs, group, &gd) < 0)
+        return -1;
+    fs->sb.s_free_blocks_count--;
+    fs->sb_dirty = 1; // Superbloco escrito em fs_sync
+    return 0;
+}
+
+/**
+ * @brief   Devolve blocos reservados com fs_reserve_blocks e não alocados.
+ *
+ * Os blocos, que nunca deixaram de estar livres no bitmap, voltam às
+ * sequências livres do índice. Blocos que não estejam reservados são ignorados.
+ *
+ * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param block  Primeiro bloco.
+ * @param count  Número de blocos (do mesmo grupo, como os de uma reserva).
+ */
+void fs_unreserve_blocks(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    if (block < fs->sb.s_first_data_block || !count)
+        return;
+    uint32_t rel = block - fs->sb.s_first_data_block;
+    uint32_t group = rel / fs->sb.s_blocks_per_group;
+    uint32_t idx = rel % fs->sb.s_blocks_per_group;
+    if (fs_freeidx_unreserve(fs, group, idx, count) == 0)
+        fs_freeidx_put(fs, group, idx, count);
+}
+
+/**
+ * @brief   Aloca um bloco livre no sistema de arquivos EXT2.
+ *
+ * Esta função procura por um bloco livre no sistema de arquivos e o aloca,
+ * retornando o número do bloco alocado em 'out_block'. É uma alocação de
+ * uma sequência de um único bloco com fs_alloc_blocks, o mais perto possível de 'goal'.
+ *
+ * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param goal       Bloco preferido (0 para começar pelo primeiro grupo), por exemplo de fs_block_goal.
+ * @param out_block  Ponteiro onde o número do bloco alocado será armazenado.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver blocos livres).
+ */
+int fs_alloc_block(ext2_fs_t *fs, uint32_t goal, uint32_t *out_block)
+{
+    uint32_t len;
+    return fs_alloc_blocks(fs, goal, 1, out_block, &len);
+}
+
+/**
+ * @brief   Libera um bloco no sistema de arquivos EXT2.
+ *
+ * Esta função marca um bloco como livre, atualizando o bitmap de blocos e o descritor de grupo correspondente.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param block Número do bloco a ser liberado.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se o bloco já estiver livre).
+ */
+int fs_free_block(ext2_fs_t *fs, uint32_t block)
+{
+    if (block < fs->sb.s_first_data_block) // Verifica se o bloco é válido
+    {
+        return -1;
+    }
+    uint32_t rel = block - fs->sb.s_first_data_block; // Calcula o número relativo do bloco
+    uint32_t group = rel / fs->sb.s_blocks_per_group; // Determina o grupo do bloco
+    uint32_t idx = rel % fs->sb.s_blocks_per_group;   // Calcula o índice do bloco dentro do grupo
+
+    struct ext2_group_desc gd;
+    if (fs_read_group_desc(fs, group, &gd) < 0) // Lê o descritor de grupo
+    {
+        return -1;
+    }
+
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    if (fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0) // Lê o bitmap de blocos do grupo
+    {
+        return -1;
+    }
+
+    int bit = bitmap[BIT_BYTE(idx)] & BIT_MASK(idx); // Verifica se o bloco está livre
+
+    if (!bit)
+    {
+        return -1;
+    }
+
+    bitmap[BIT_BYTE(idx)] &= ~BIT_MASK(idx);                // Marca o bloco como livre
+    gd.bg_free_blocks_count++;                              // Incrementa o contador de blocos livres
+    fs->sb.s_free_blocks_count++;                           // Incrementa o contador de blocos livres no superbloco
+    if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0) // Escreve o bitmap atualizado no disco
+    {
+        return -1;
+    }
+    fs_freeidx_put(fs, group, idx, 1);           // Devolve o bloco ao índice de espaço livre
+    if (fs_write_group_desc(fs, group, &gd) < 0) // Atualiza o descritor de grupo no disco
+    {
+        return -1;
+    }
+
+    fs->sb_dirty = 1; // Superbloco escrito em fs_sync
+
+    return 0;
+}
+
+/**
+ * @brief   Sequência de blocos físicos a liberar.
+ */
+struct free_span
+{
+    uint32_t block; // Primeiro bloco (absoluto)
+    uint32_t len;   // Número de blocos
+};
+
+/**
+ * @brief   Lista de sequências coletadas antes de liberar os blocos de um arquivo.
+ */
+struct free_list
+{
+    struct free_span *spans; // Sequências coletadas
+    uint32_t count;          // Número de sequências
+    uint32_t cap;            // Capacidade alocada
+};
+
+/**
+ * @brief   Compara duas sequências pelo primeiro bloco (para qsort).
+ */
+static int free_span_cmp(const void *a, const void *b)
+{
+    uint32_t x = ((const struct free_span *)a)->block;
+    uint32_t y = ((const struct free_span *)b)->block;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief   Grupo tocado por free_spans, com uma cópia do seu bitmap de blocos.
+ */
+struct free_group
+{
+    uint32_t group;            // Número do grupo
+    uint32_t freed;            // Blocos liberados no grupo
+    struct ext2_group_desc gd; // Descritor do grupo
+    uint8_t *bitmap;           // Cópia do bitmap de blocos
+};
+
+/**
+ * @brief   Parte de uma sequência que cai em um único grupo.
+ */
+struct free_piece
+{
+    uint32_t group; // Índice em free_group
+    uint32_t idx;   // Primeiro bloco dentro do grupo
+    uint32_t len;   // Número de blocos
+};
+
+/**
+ * @brief   Libera sequências de blocos em ordem crescente, sem sobreposição.
+ *
+ * A operação é tudo ou nada: primeiro todas as sequências são validadas, os
+ * descritores e bitmaps de todos os grupos tocados são lidos e é verificado
+ * que nenhum bloco já está livre; só então os bitmaps são alterados. O bitmap
+ * de cada grupo é escrito e o descritor é atualizado uma única vez, por mais
+ * sequências que caiam no grupo.
+ *
+ * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param spans  Sequências ordenadas pelo primeiro bloco.
+ * @param n      Número de sequências.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (nada é liberado).
+ */
+static int free_spans(ext2_fs_t *fs, const struct free_span *spans, uint32_t n)
+{
+    uint32_t first = fs->sb.s_first_data_block;
+    uint32_t per = fs->sb.s_blocks_per_group;
+    uint32_t ngroups = 0, npieces = 0, last = UINT32_MAX;
+    for (uint32_t i = 0; i < n; ++i) // Valida as sequências e conta grupos e partes
+    {
+        if (!spans[i].len || spans[i].block < first || spans[i].len > fs->sb.s_blocks_count - spans[i].block)
+            return -1;
+        uint32_t g0 = (spans[i].block - first) / per;
+        uint32_t g1 = (spans[i].block + spans[i].len - 1 - first) / per;
+        npieces += g1 - g0 + 1;
+        ngroups += g1 - g0 + 1 - (g0 == last); // Sequências ordenadas: um grupo repetido só pode ser o último visto
+        last = g1;
+    }
+    if (!n)
+        return 0;
+
+    struct free_group *groups = calloc(ngroups, sizeof(*groups));
+    struct free_piece *pieces = malloc(npieces * sizeof(*pieces));
+    uint8_t *maps = malloc((size_t)ngroups * fs->block_size);
+    int ret = groups && pieces && maps ? 0 : -1;
+
+    uint32_t k = 0, p = 0; // Grupos e partes já montados
+    for (uint32_t i = 0; i < n && ret == 0; ++i) // Lê os bitmaps e verifica que todos os blocos estão ocupados
+    {
+        uint32_t block = spans[i].block, left = spans[i].len;
+        while (left && ret == 0)
+        {
+            uint32_t group = (block - first) / per;
+            uint32_t idx = (block - first) % per;
+            uint32_t len = left < per - idx ? left : per - idx; // Parte da sequência dentro deste grupo
+            if (!k || groups[k - 1].group != group)
+            {
+                struct free_group *fg = &groups[k];
+                fg->group = group;
+                fg->bitmap = maps + (size_t)k * fs->block_size;
+                k++;
+                if (fs_read_group_desc(fs, group, &fg->gd) < 0 || fs_read_block(fs, fg->gd.bg_block_bitmap, fg->bitmap) < 0)
+                    ret = -1;
+            }
+            uint32_t clear;
+            if (ret == 0 && bitmap_find_clear(groups[k - 1].bitmap, idx + len, idx, &clear) == 0) // Algum bloco já está livre
+                ret = -1;
+            pieces[p++] = (struct free_piece){k - 1, idx, len};
+            block += len;
+            left -= len;
+        }
+    }
+
+    for (uint32_t j = 0; j < p && ret == 0; ++j) // Tudo verificado: libera os blocos
+    {
+        struct free_group *fg = &groups[pieces[j].group];
+        bitmap_clear_run(fg->bitmap, pieces[j].idx, pieces[j].len);
+        fs_freeidx_put(fs, fg->group, pieces[j].idx, pieces[j].len);
+        fg->freed += pieces[j].len;
+    }
+    for (uint32_t g = 0; g < k && ret == 0; ++g) // Uma escrita do bitmap e do descritor por grupo
+    {
+        struct free_group *fg = &groups[g];
+        fg->gd.bg_free_blocks_count += fg->freed;
+        fs->sb.s_free_blocks_count += fg->freed;
+        if (fs_write_block(fs, fg->gd.bg_block_bitmap, fg->bitmap) < 0 || fs_write_group_desc(fs, fg->group, &fg->gd) < 0)
+            ret = -1;
+    }
+    if (ret == 0)
+        fs->sb_dirty = 1; // Superbloco escrito em fs_sync
+
+    free(groups);
+    free(pieces);
+    free(maps);
+    return ret;
+}
+
+/**
+ * @brief   Libera uma sequência de blocos contíguos no sistema de arquivos EXT2.
+ *
+ * Cada grupo tocado pela sequência tem o bitmap, o descritor e o índice de
+ * espaço livre atualizados uma única vez.
+ *
+ * @param fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param block  Primeiro bloco da sequência.
+ * @param count  Número de blocos.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se algum bloco já estiver livre).
+ */
+int fs_free_blocks(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    if (block < fs->sb.s_first_data_block || count > fs->sb.s_blocks_count - block) // Verifica se a sequência é válida
+        return -1;
+
+    struct free_span span = {block, count};
+    return free_spans(fs, &span, count ? 1 : 0);
+}
+
+/**
+ * @brief   Coleta as sequências reportadas pelo mapa de blocos.
+ *
+ * Callback de fs_map_blocks usado por free_inode_blocks. Buracos são ignorados
+ * e uma sequência contígua à anterior é juntada a ela.
+ */
+static int free_collect_cb(const struct fs_block_run *run, void *user)
+{
+    struct free_list *list = user;
+    if (!run->physical)
+        return 0;
+
+    if (list->count)
+    {
+        struct free_span *last = &list->spans[list->count - 1];
+        if (last->block + last->len == run->physical)
+        {
+            last->len += run->len;
+            return 0;
+        }
+    }
+    if (list->count == list->cap)
+    {
+        uint32_t cap = list->cap ? list->cap * 2 : 16;
+        struct free_span *spans = realloc(list->spans, cap * sizeof(*spans));
+        if (!spans)
+            return -1;
+        list->spans = spans;
+        list->cap = cap;
+    }
+    list->spans[list->count++] = (struct free_span){run->physical, run->len};
+    return 0;
+}
+
+/**
+ * @brief Libera todos os blocos associados a um inode.
+ *
+ * Percorre o mapa de blocos inteiro (diretos e indiretos simples, duplos e
+ * triplos, independentemente de i_size) e coleta os blocos de dados e os
+ * próprios blocos indiretos. As sequências coletadas são ordenadas e
+ * liberadas grupo a grupo, com uma escrita de bitmap por grupo tocado.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos.
+ * @param inode Ponteiro para o inode cujos blocos serão liberados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int free_inode_blocks(ext2_fs_t *fs, struct ext2_inode *inode)
+{
+    struct free_list list = {0};
+    if (fs_map_blocks(fs, inode, UINT32_MAX, FS_BMAP_META, free_collect_cb, &list))
+    {
+        free(list.spans);
+        return -1;
+    }
+
+    qsort(list.spans, list.count, sizeof(*list.spans), free_span_cmp);
+    uint32_t n = 0; // Junta as sequências que ficaram adjacentes após a ordenação
+    int ret = 0;
+    for (uint32_t i = 0; i < list.count && !ret; ++i)
+    {
+        uint32_t prev_end = n ? list.spans[n - 1].block + list.spans[n - 1].len : 0;
+        if (n && prev_end > list.spans[i].block) // Bloco referenciado duas vezes: mapa corrompido
+            ret = -1;
+        else if (n && prev_end == list.spans[i].block)
+            list.spans[n - 1].len += list.spans[i].len;
+        else
+            list.spans[n++] = list.spans[i];
+    }
+
+    if (!ret)
+        ret = free_spans(fs, list.spans, n);
+    free(list.spans);
+    return ret;
+}
+
+/**
+ * @brief   Estado de um percurso pelo mapa de blocos de um inode.
+ */
+struct bmap_walk
+{
+    ext2_fs_t *fs;           // Sistema de arquivos
+    int flags;               // Opções do percurso (FS_BMAP_*)
+    block_run_cb cb;         // Callback chamado para cada sequência
+    void *user;              // Dados do usuário repassados ao callback
+    uint32_t next;           // Próximo bloco lógico
+    uint32_t end;            // Fim do percurso (exclusivo)
+    struct fs_block_run run; // Sequência em formação (len 0 se vazia)
+};
+
+/**
+ * @brief   Entrega ao callback a sequência em formação, se houver.
+ *
+ * @return  Retorna 0 para continuar ou o valor não nulo devolvido pelo callback.
+ */
+static int bmap_flush(struct bmap_walk *w)
+{
+    if (!w->run.len)
+        return 0;
+    int stop = w->cb(&w->run, w->user);
+    w->run.len = 0;
+    return stop;
+}
+
+/**
+ * @brief   Acrescenta blocos lógicos ao percurso, juntando-os à sequência em formação
+ *          quando forem fisicamente contíguos a ela (ou quando ambos forem buracos).
+ *
+ * @param   w         Estado do percurso.
+ * @param   physical  Bloco físico do próximo bloco lógico (0 para buraco).
+ * @param   count     Número de blocos lógicos (maior que 1 apenas para buracos).
+ *
+ * @return  Retorna 0 para continuar ou o valor não nulo devolvido pelo callback.
+ */
+static int bmap_add(struct bmap_walk *w, uint32_t physical, uint64_t count)
+{
+    if (count > w->end - w->next) // Não passa do fim do percurso
+        count = w->end - w->next;
+    if (!count)
+        return 0;
+
+    struct fs_block_run *r = &w->run;
+    int contiguous = physical ? r->physical && physical == r->physical + r->len : !r->physical;
+    if (!r->len || !contiguous) // Inicia uma nova sequência
+    {
+        int stop = bmap_flush(w);
+        if (stop)
+            return stop;
+        r->logical = w->next;
+        r->physical = physical;
+        r->meta = 0;
+    }
+    r->len += (uint32_t)count;
+    w->next += (uint32_t)count;
+    return 0;
+}
+
+/**
+ * @brief   Percorre um bloco indireto de profundidade 'depth' (1 = simples, 2 = duplo, 3 = triplo).
+ *
+ * Um ponteiro nulo vira um único buraco cobrindo toda a sua subárvore. Com
+ * FS_BMAP_META, o próprio bloco indireto é reportado depois dos blocos que aponta.
+ *
+ * @return  Retorna 0 para continuar, o valor não nulo devolvido pelo callback ou -1 em caso de erro.
+ */
+static int bmap_indirect(struct bmap_walk *w, uint32_t block, int depth)
+{
+    ext2_fs_t *fs = w->fs;
+    uint64_t span = 1; // Blocos lógicos cobertos por cada entrada da tabela
+    for (int i = 1; i < depth; ++i)
+        span *= fs->ptrs_per_block;
+
+    if (!block) // Subárvore inteira ausente
+        return bmap_add(w, 0, span * fs->ptrs_per_block);
+
+    uint32_t tbl[EXT2_MAX_PTRS_PER_BLOCK]; // Tabela de ponteiros do bloco indireto
+    if (fs_read_block(fs, block, tbl) < 0)
+        return -1;
+
+    int stop = 0;
+    for (uint32_t i = 0; i < fs->ptrs_per_block && w->next < w->end && !stop; ++i)
+        stop = depth == 1 ? bmap_add(w, tbl[i], 1) : bmap_indirect(w, tbl[i], depth - 1);
+
+    if (!stop && (w->flags & FS_BMAP_META)) // Reporta o próprio bloco indireto
+    {
+        struct fs_block_run meta = {w->next, block, 1, 1};
+        stop = w->cb(&meta, w->user);
+    }
+    return stop;
+}
+
+/**
+ * @brief   Calcula o número de blocos lógicos ocupados pelo conteúdo de um arquivo.
+ *
+ * @param   fs     Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode  Inode do arquivo.
+ *
+ * @return  Número de blocos lógicos (i_size arredondado para cima).
+ */
+uint32_t fs_file_blocks(ext2_fs_t *fs, const struct ext2_inode *inode)
+{
+    return (uint32_t)(((uint64_t)inode->i_size + fs->block_size - 1) / fs->block_size);
+}
 
-    return fs_sync_super(fs); // Sincroniza o superbloco
+/**
+ * @brief   Percorre o mapa de blocos de um inode, do bloco lógico 0 até 'nblocks'.
+ *
+ * Os blocos diretos e os apontados pelos blocos indiretos simples, duplos e
+ * triplos são entregues ao callback como sequências (bloco lógico, bloco
+ * físico, tamanho), juntando blocos fisicamente contíguos em uma só sequência.
+ * Blocos não alocados formam sequências com physical == 0 (buracos). Com
+ * FS_BMAP_META, os blocos indiretos também são entregues, um a um, com meta = 1.
+ *
+ * @param   fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   inode    Inode cujo mapa será percorrido.
+ * @param   nblocks  Número de blocos lógicos a percorrer (UINT32_MAX para o mapa inteiro).
+ * @param   flags    Opções do percurso (FS_BMAP_*).
+ * @param   cb       Função chamada para cada sequência; um retorno não nulo interrompe o percurso.
+ * @param   user     Dados do usuário repassados ao callback.
+ *
+ * @return  Retorna 0 ao fim do percurso, o valor não nulo devolvido pelo callback ou -1 em caso de erro.
+ */
+int fs_map_blocks(ext2_fs_t *fs, const struct ext2_inode *inode, uint32_t nblocks, int flags, block_run_cb cb, void *user)
+{
+    uint32_t ptrs[EXT2_N_BLOCKS]; // Cópia dos ponteiros do inode (a estrutura é compactada)
+    memcpy(ptrs, inode->i_block, sizeof(ptrs));
+
+    uint64_t p = fs->ptrs_per_block;
+    uint64_t max = 12 + p + p * p + p * p * p; // Blocos lógicos endereçáveis pelo inode
+    struct bmap_walk w = {fs, flags, cb, user, 0, (uint32_t)(nblocks < max ? nblocks : (max < UINT32_MAX ? max : UINT32_MAX)), {0, 0, 0, 0}};
+
+    int stop = 0;
+    for (int i = 0; i < 12 && w.next < w.end && !stop; ++i) // Blocos diretos
+        stop = bmap_add(&w, ptrs[i], 1);
+    for (int depth = 1; depth <= 3 && w.next < w.end && !stop; ++depth) // Indireto simples, duplo e triplo
+        stop = bmap_indirect(&w, ptrs[11 + depth], depth);
+    if (!stop)
+        stop = bmap_flush(&w);
+    return stop;
 }
 
 /**
- * @brief   Imprime as informações de uma entrada de diretório.
+ * @brief   Procura o primeiro extent que termina depois de um bloco lógico (busca binária).
  *
- * Esta função exibe o nome, inode, comprimento do registro, comprimento do nome
- * e tipo de arquivo de uma entrada de diretório.
+ * @param   ext      Extents em ordem crescente de bloco lógico.
+ * @param   count    Número de extents.
+ * @param   logical  Bloco lógico procurado.
  *
- * @param e  Ponteiro para a entrada de diretório a ser impressa.
+ * @return  Índice do extent que contém o bloco ou do próximo extent (count se não houver).
  */
-void print_entry(struct ext2_dir_entry *e)
+static uint32_t extent_find(const struct fs_extent *ext, uint32_t count, uint32_t logical)
 {
-    char name[256];
-    size_t n = e->name_len < 255 ? e->name_len : 255;
-    memcpy(name, e->name, n);
-    name[n] = '\0';
+    uint32_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (ext[mid].logical + ext[mid].len <= logical)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
 
-    if (e->file_type == 1)
-        printf("\033[32m%s\033[0m\n", name);
-    else if (e->file_type == 2)
-        printf("\033[34m%s\033[0m\n", name);
+#define COPY_RANGE 0    // Cópia pelo kernel com copy_file_range
+#define COPY_SENDFILE 1 // Cópia pelo kernel com sendfile
+#define COPY_NONE 2     // Sem cópia pelo kernel: só leitura e escrita comuns
 
-    printf("inode: %u\n", e->inode);
-    printf("record length: %u\n", e->rec_len);
-    printf("name length: %u\n", e->name_len);
-    printf("file type: %u\n", e->file_type);
-    printf("\n");
+/**
+ * @brief   Verifica se algum bloco de uma sequência está sujo na cache de blocos.
+ */
+static int range_dirty(ext2_fs_t *fs, uint32_t block, uint32_t count)
+{
+    if (!fs->bcache.dirty)
+        return 0;
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        struct fs_buf *b = fs_buf_peek(fs, block + k);
+        if (b && b->dirty)
+            return 1;
+    }
+    return 0;
 }
 
 /**
- * @brief   Aloca um bloco livre no sistema de arquivos EXT2.
+ * @brief   Copia um trecho da imagem para um descritor sem passar pelo espaço do usuário.
  *
- * Esta função procura por um bloco livre no sistema de arquivos e o aloca,
- * retornando o número do bloco alocado em 'out_block'.
+ * Usa copy_file_range e, se ele não for aceito para esse par de arquivos
+ * (kernel antigo, sistemas de arquivos diferentes, destino aberto com
+ * O_APPEND...), sendfile. Qualquer falha antes do primeiro byte copiado conta
+ * como método não aceito. O método que funcionou fica em 'method' para os
+ * próximos trechos.
  *
- * @param fs         Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param out_block  Ponteiro onde o número do bloco alocado será armazenado.
+ * @param   fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   out_fd  Descritor de destino (escrito na posição atual).
+ * @param   off     Offset do trecho na imagem.
+ * @param   len     Tamanho do trecho.
+ * @param   method  Método atual (COPY_*), atualizado se um método não for aceito.
  *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se não houver blocos livres).
+ * @return  0 se o trecho foi copiado, 1 se nenhum método foi aceito (nada foi copiado) ou -1 em caso de erro.
  */
-int fs_alloc_block(ext2_fs_t *fs, uint32_t *out_block)
+static int copy_kernel(ext2_fs_t *fs, int out_fd, off_t off, size_t len, int *method)
 {
-    uint8_t bitmap[EXT2_BLOCK_SIZE];
-
-    // Percorre todos os grupos de blocos
-    for (uint32_t group = 0; group < fs->groups_count; ++group)
+    int copied = 0;
+    while (len)
     {
-        struct ext2_group_desc gd;
-        if (fs_read_group_desc(fs, group, &gd) < 0)
-            return -1;
-
-        // Se não há blocos livres neste grupo, pula para o próximo
-        if (gd.bg_free_blocks_count == 0)
-            continue;
-
-        // Lê o bitmap de blocos do grupo
-        if (fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0)
-            return -1;
-
-        // Procura por um bloco livre no bitmap
-        for (uint32_t idx = 0; idx < fs->sb.s_blocks_per_group; ++idx)
+        ssize_t n;
+        loff_t in = off;
+        if (*method == COPY_RANGE)
+            n = copy_file_range(fs->fd, &in, out_fd, NULL, len, 0);
+        else if (*method == COPY_SENDFILE)
+            n = sendfile(out_fd, fs->fd, &in, len);
+        else
+            return 1;
+
+        if (n > 0)
         {
-            if (!(bitmap[BIT_BYTE(idx)] & BIT_MASK(idx)))
-            {
-                // Marca o bloco como usado
-                bitmap[BIT_BYTE(idx)] |= BIT_MASK(idx);
-                if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0)
-                    return -1;
-
-                gd.bg_free_blocks_count--;
-                if (fs_write_group_desc(fs, group, &gd) < 0)
-                    return -1;
-
-                fs->sb.s_free_blocks_count--;
-                fs_sync_super(fs);
-
-                // Calcula o número absoluto do bloco
-                *out_block = fs->sb.s_first_data_block + group * fs->sb.s_blocks_per_group + idx;
-                return 0;
-            }
+            copied = 1;
+            off += n;
+            len -= (size_t)n;
         }
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else if (n < 0 && !copied) // Método não aceito (ex.: EBADF em destino O_APPEND): tenta o próximo
+            (*method)++;
+        else // Erro ou fim inesperado da imagem
+            return -1;
     }
-    return -1;
+    return 0;
 }
 
 /**
- * @brief   Libera um bloco no sistema de arquivos EXT2.
+ * @brief   Escreve o conteúdo de um arquivo regular em um arquivo do sistema real.
  *
- * Esta função marca um bloco como livre, atualizando o bitmap de blocos e o descritor de grupo correspondente.
+ * Sequências fisicamente contíguas de pelo menos FS_COPY_MIN_BYTES são copiadas
+ * pelo kernel (copy_kernel) direto da imagem para o destino, sem cópias no
+ * espaço do usuário, quando o destino é um arquivo regular, o backend é o
+ * file e nenhum bloco da sequência está sujo na cache. O resto (buracos,
+ * sequências curtas, blocos alterados ainda não gravados) é lido com
+ * fs_read_file em lotes de até FS_READ_BATCH_BYTES, com leitura antecipada, e
+ * escrito com fwrite.
  *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
- * @param block Número do bloco a ser liberado.
+ * @param   fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino  Número do inode do arquivo.
+ * @param   out  Destino do conteúdo (por exemplo, stdout).
  *
- * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro (por exemplo, se o bloco já estiver livre).
+ * @return  Retorna 0 em caso de sucesso ou -1 em caso de erro.
  */
-int fs_free_block(ext2_fs_t *fs, uint32_t block)
+int fs_dump_file(ext2_fs_t *fs, uint32_t ino, FILE *out)
 {
-    if (block < fs->sb.s_first_data_block) // Verifica se o bloco é válido
+    struct ext2_inode *inode = fs_iget(fs, ino);
+    if (!inode)
+        return -1;
+    const struct fs_extent *ext;
+    uint32_t count;
+    if (fs_inode_extents(fs, inode, &ext, &count) < 0)
     {
+        fs_iput(fs, inode);
         return -1;
     }
-    uint32_t rel = block - fs->sb.s_first_data_block; // Calcula o número relativo do bloco
-    uint32_t group = rel / fs->sb.s_blocks_per_group; // Determina o grupo do bloco
-    uint32_t idx = rel % fs->sb.s_blocks_per_group;   // Calcula o índice do bloco dentro do grupo
 
-    struct ext2_group_desc gd;
-    if (fs_read_group_desc(fs, group, &gd) < 0) // Lê o descritor de grupo
+    uint64_t size = inode->i_size;
+    size_t chunk = size < FS_READ_BATCH_BYTES ? (size_t)size : FS_READ_BATCH_BYTES; // Arquivos pequenos não precisam de um lote inteiro
+    uint8_t *buf = chunk ? malloc(chunk) : NULL;
+    if (chunk && !buf)
     {
+        fs_iput(fs, inode);
         return -1;
     }
 
-    uint8_t bitmap[EXT2_BLOCK_SIZE];
-    if (fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0) // Lê o bitmap de blocos do grupo
+    struct stat st;
+    int method = fs->io == &fs_io_file && fstat(fileno(out), &st) == 0 && S_ISREG(st.st_mode) ? COPY_RANGE : COPY_NONE;
+    uint32_t bs = fs->block_size;
+    uint32_t min = (FS_COPY_MIN_BYTES + bs - 1) / bs; // Menor sequência copiada pelo kernel, em blocos
+    uint64_t off = 0;
+    int ret = 0;
+    while (off < size && ret == 0)
     {
-        return -1;
+        uint32_t cur = (uint32_t)(off / bs); // Os trechos copiados terminam em fim de bloco (ou no fim do arquivo)
+        uint32_t i = extent_find(ext, count, cur);
+        uint64_t want = size - off;
+        if (method != COPY_NONE && i < count && ext[i].logical <= cur && ext[i].logical + ext[i].len - cur >= min)
+        {
+            uint32_t phys = ext[i].physical + (cur - ext[i].logical);
+            uint64_t n = (uint64_t)(ext[i].logical + ext[i].len - cur) * bs;
+            if (n > want)
+                n = want;
+            if (!range_dirty(fs, phys, (uint32_t)((n + bs - 1) / bs)))
+            {
+                int r = fflush(out) == 0 ? copy_kernel(fs, fileno(out), fs_block_offset(fs, phys), (size_t)n, &method) : -1;
+                if (r < 0)
+                    ret = -1;
+                else if (r == 0)
+                    off += n;
+                if (r <= 0)
+                    continue;
+            }
+        }
+
+        size_t n = want < chunk ? (size_t)want : chunk; // Cópia comum até o início da próxima sequência longa
+        for (uint32_t j = i < count && ext[i].logical <= cur ? i + 1 : i; method != COPY_NONE && j < count && (uint64_t)(ext[j].logical - cur) * bs < n; ++j)
+            if (ext[j].len >= min)
+            {
+                n = (size_t)(ext[j].logical - cur) * bs;
+                break;
+            }
+        ssize_t r = fs_read_file(fs, ino, buf, n, (off_t)off);
+        if (r <= 0 || fwrite(buf, 1, (size_t)r, out) != (size_t)r)
+            ret = -1;
+        else
+            off += (uint64_t)r;
     }
 
-    int bit = bitmap[BIT_BYTE(idx)] & BIT_MASK(idx); // Verifica se o bloco está livre
+    free(buf);
+    fs_iput(fs, inode);
+    return ret;
+}
 
-    if (!bit)
-    {
+/**
+ * @brief   Lê um trecho de um arquivo a partir de um deslocamento qualquer.
+ *
+ * O mapa de blocos é consultado pela lista de extents em cache do inode
+ * (fs_inode_extents), de modo que leituras repetidas em posições aleatórias
+ * não voltam a ler os blocos indiretos: o primeiro bloco do trecho é localizado
+ * por busca binária e os blocos seguintes são lidos em lotes com fs_read_runs.
+ * Buracos são lidos como zeros. Leituras sequenciais do mesmo arquivo ativam a
+ * leitura antecipada dos blocos seguintes (fs_inode_readahead).
+ *
+ * @param   fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param   ino  Número do inode do arquivo.
+ * @param   buf  Buffer de destino.
+ * @param   len  Número de bytes a ler.
+ * @param   off  Deslocamento no arquivo.
+ *
+ * @return  Número de bytes lidos (0 no fim do arquivo) ou -1 em caso de erro.
+ */
+ssize_t fs_read_file(ext2_fs_t *fs, uint32_t ino, void *buf, size_t len, off_t off)
+{
+    struct ext2_inode *inode = fs_iget(fs, ino);
+    if (!inode)
         return -1;
-    }
 
-    bitmap[BIT_BYTE(idx)] &= ~BIT_MASK(idx);                // Marca o bloco como livre
-    gd.bg_free_blocks_count++;                              // Incrementa o contador de blocos livres
-    fs->sb.s_free_blocks_count++;                           // Incrementa o contador de blocos livres no superbloco
-    if (fs_write_block(fs, gd.bg_block_bitmap, bitmap) < 0) // Escreve o bitmap atualizado no disco
+    const struct fs_extent *ext;
+    uint32_t count;
+    if (off < 0 || fs_inode_extents(fs, inode, &ext, &count) < 0)
     {
+        fs_iput(fs, inode);
         return -1;
     }
-    if (fs_write_group_desc(fs, group, &gd) < 0) // Atualiza o descritor de grupo no disco
+    if ((uint64_t)off >= inode->i_size || !len)
     {
-        return -1;
+        fs_iput(fs, inode);
+        return 0;
     }
-
-    if (fs_sync_super(fs) < 0) // Sincroniza o superbloco
+    if (len > inode->i_size - (uint64_t)off) // Não lê além do fim do arquivo
+        len = (size_t)(inode->i_size - (uint64_t)off);
+
+    uint32_t bs = fs->block_size;
+    uint32_t cur = (uint32_t)(off / bs);                            // Próximo bloco lógico a ler
+    uint32_t end = (uint32_t)(((uint64_t)off + len + bs - 1) / bs); // Primeiro bloco lógico após o trecho
+    fs_inode_readahead(fs, inode, cur, end - cur);
+    uint32_t max_blocks = FS_READ_BATCH_BYTES / bs;
+    if (max_blocks > end - cur)
+        max_blocks = end - cur;
+    uint8_t *batch = malloc((size_t)max_blocks * bs);
+    if (!batch)
     {
+        fs_iput(fs, inode);
         return -1;
     }
 
-    return 0;
-}
-
-/**
- * @brief Libera todos os blocos de dados associados a um inode (diretos e indiretos simples).
- *
- * @param fs    Ponteiro para a estrutura do sistema de arquivos.
- * @param inode Ponteiro para o inode cujos blocos serão liberados.
- *
- * @return 0 em caso de sucesso, -1 em caso de erro.
- */
-int free_inode_blocks(ext2_fs_t *fs, struct ext2_inode *inode)
-{
-    // Diretos
-    for (int i = 0; i < 12; ++i)
+    struct fs_block_run runs[FS_READ_BATCH_RUNS];
+    uint32_t i = extent_find(ext, count, cur);
+    uint8_t *out = buf;
+    size_t done = 0;
+    int ret = 0;
+    while (cur < end && ret == 0)
     {
-        uint32_t blk = inode->i_block[i];
-        if (blk)
+        uint32_t first = cur, nruns = 0, nblocks = 0;
+        while (cur < end && nruns < FS_READ_BATCH_RUNS && nblocks < max_blocks) // Monta um lote de sequências
         {
-            if (fs_free_block(fs, blk) < 0)
+            struct fs_block_run *r = &runs[nruns++];
+            uint32_t stop;
+            r->logical = cur;
+            r->meta = 0;
+            if (i < count && ext[i].logical <= cur) // Dentro de um extent
             {
-                return -1;
+                r->physical = ext[i].physical + (cur - ext[i].logical);
+                stop = ext[i].logical + ext[i].len;
+            }
+            else // Buraco até o próximo extent
+            {
+                r->physical = 0;
+                stop = i < count ? ext[i].logical : end;
             }
+            if (stop > end)
+                stop = end;
+            if (stop - cur > max_blocks - nblocks)
+                stop = cur + (max_blocks - nblocks);
+            r->len = stop - cur;
+            nblocks += r->len;
+            cur = stop;
+            if (i < count && cur >= ext[i].logical + ext[i].len)
+                i++;
         }
-    }
 
-    // Use existing free_indirect_chain if available
-    extern int free_indirect_chain(ext2_fs_t *, uint32_t, int);
-    if (inode->i_block[12] && free_indirect_chain(fs, inode->i_block[12], 1) < 0)
-        return -1;
-    if (inode->i_block[13] && free_indirect_chain(fs, inode->i_block[13], 2) < 0)
-        return -1;
-    if (inode->i_block[14] && free_indirect_chain(fs, inode->i_block[14], 3) < 0)
-        return -1;
+        if (fs_read_runs(fs, runs, nruns, batch) < 0)
+        {
+            ret = -1;
+            break;
+        }
 
-    return 0;
+        uint64_t start = (uint64_t)first * bs; // Recorta do lote a parte pedida
+        size_t skip = (uint64_t)off + done > start ? (size_t)((uint64_t)off + done - start) : 0;
+        size_t n = (size_t)nblocks * bs - skip;
+        if (n > len - done)
+            n = len - done;
+        memcpy(out + done, batch + skip, n);
+        done += n;
+    }
+
+    free(batch);
+    fs_iput(fs, inode);
+    return ret < 0 ? -1 : (ssize_t)done;
 }
 
 /**
@@ -589,7 +1816,7 @@ int fs_iterate_dir(ext2_fs_t *fs, struct ext2_inode *dir_inode, dir_iter_cb cb,
         return -1;
     }
 
-    uint8_t block_buf[EXT2_BLOCK_SIZE];
+    uint8_t copy_buf[EXT2_MAX_BLOCK_SIZE];
 
     // Percorre apenas os blocos diretos do diretório
     for (int i = 0; i < 12; ++i)
@@ -598,11 +1825,16 @@ int fs_iterate_dir(ext2_fs_t *fs, struct ext2_inode *dir_inode, dir_iter_cb cb,
         if (!block_num)
             continue; // Pula blocos não alocados
 
-        if (fs_read_block(fs, block_num, block_buf) < 0)
-            return -1;
+        uint8_t *block_buf = fs_block_ptr(fs, block_num); // Com a imagem em memória, lê o bloco sem cópia
+        if (!block_buf)
+        {
+            if (fs_read_block(fs, block_num, copy_buf) < 0)
+                return -1;
+            block_buf = copy_buf;
+        }
 
         uint32_t offset = 0;
-        while (offset < EXT2_BLOCK_SIZE)
+        while (offset < fs->block_size)
         {
             struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(block_buf + offset);
             if (entry->rec_len == 0)
@@ -681,6 +1913,53 @@ int fs_find_in_dir(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name, uint
     return 0;
 }
 
+/**
+ * @brief   Procura um nome em um diretório, consultando antes a cache de entradas.
+ *
+ * Em caso de acerto na cache, o disco não é acessado. Em caso de falta, o
+ * diretório é percorrido e o resultado (inclusive a ausência do nome) é
+ * registrado na cache.
+ *
+ * @param fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param dir_ino  Inode do diretório onde a busca será realizada.
+ * @param name     Nome a ser buscado no diretório.
+ * @param out_ino  Ponteiro onde o inode encontrado será armazenado.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 se o nome não existir ou em caso de erro.
+ */
+int fs_lookup(ext2_fs_t *fs, uint32_t dir_ino, char *name, uint32_t *out_ino)
+{
+    uint32_t ino;
+    if (fs_dcache_lookup(fs, dir_ino, name, &ino) == 0) // Acerto na cache (positivo ou negativo)
+    {
+        if (ino == 0)
+            return -1;
+        *out_ino = ino;
+        return 0;
+    }
+
+    struct ext2_inode *dir_inode = fs_iget(fs, dir_ino); // Obtém o inode do diretório da cache
+    if (!dir_inode)
+        return -1;
+    if (!ext2_is_dir(dir_inode)) // Apenas diretórios contêm nomes
+    {
+        fs_iput(fs, dir_inode);
+        return -1;
+    }
+
+    struct dir_find_ctx ctx = {.name = name, .ino = 0};     // Inicializa o contexto de busca
+    int ret = fs_iterate_dir(fs, dir_inode, find_cb, &ctx); // Itera sobre o diretório
+    fs_iput(fs, dir_inode);
+    if (ret < 0) // Erro de leitura: nada é registrado na cache
+        return -1;
+
+    fs_dcache_add(fs, dir_ino, name, ctx.ino); // Registra o resultado (0 se o nome não existir)
+    if (ctx.ino == 0)
+        return -1;
+    *out_ino = ctx.ino;
+    return 0;
+}
+
 /**
  * @brief   Calcula o tamanho necessário para uma entrada de diretório.
  *
@@ -733,20 +2012,7 @@ int fs_path_resolve(ext2_fs_t *fs, char *path, uint32_t *ino)
 
     while (token)
     {
-        struct ext2_inode dir_inode;
-        if (fs_read_inode(fs, current_ino, &dir_inode) < 0) // Lê o inode do diretório atual
-        {
-            free(path_copy);
-            return -1;
-        }
-
-        if (!ext2_is_dir(&dir_inode)) // Verifica se o inode atual é um diretório
-        {
-            free(path_copy);
-            return -1;
-        }
-
-        if (fs_find_in_dir(fs, &dir_inode, token, &current_ino) < 0) // Procura o próximo componente no diretório atual
+        if (fs_lookup(fs, current_ino, token, &current_ino) < 0) // Procura o próximo componente no diretório atual
         {
             free(path_copy);
             return -1;
@@ -797,11 +2063,53 @@ static int child_cb(struct ext2_dir_entry *entry, void *user_ctx)
     return 0;
 }
 
+/**
+ * @brief   Obtém o diretório pai e o nome de um inode.
+ *
+ * Consulta primeiro o índice reverso da cache de entradas de diretório. Em caso
+ * de falta, procura ".." no diretório e o nome correspondente no pai, registrando
+ * o resultado na cache para as próximas consultas.
+ *
+ * @param fs      Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param ino     Número do inode do diretório.
+ * @param parent  Ponteiro onde o inode do diretório pai será armazenado.
+ * @param name    Buffer (EXT2_NAME_LEN + 1 bytes) onde o nome será copiado.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro.
+ */
+static int parent_name(ext2_fs_t *fs, uint32_t ino, uint32_t *parent, char *name)
+{
+    const char *cached;
+    if (fs_dcache_reverse(fs, ino, parent, &cached) == 0) // Acerto no índice reverso
+    {
+        strcpy(name, cached);
+        return 0;
+    }
+
+    if (fs_lookup(fs, ino, "..", parent) < 0) // Procura o inode do pai
+        return -1;
+
+    struct ext2_inode *parent_inode = fs_iget(fs, *parent); // Obtém o inode do pai da cache
+    if (!parent_inode)
+        return -1;
+
+    struct child_ctx ctx = {.ino = ino};                          // Inicializa o contexto de busca para o filho
+    int found = fs_iterate_dir(fs, parent_inode, child_cb, &ctx); // Itera sobre o diretório pai para encontrar o nome do filho
+    fs_iput(fs, parent_inode);
+    if (found <= 0) // Erro de leitura ou filho não encontrado
+        return -1;
+
+    strcpy(name, ctx.name);
+    fs_dcache_add(fs, *parent, name, ino); // Registra o par (pai, nome) na cache
+    return 0;
+}
+
 /**
  * @brief   Obtém o caminho completo de um inode no sistema de arquivos EXT2.
  *
  * Esta função constrói o caminho completo a partir do inode fornecido, subindo pela hierarquia de diretórios
- * até chegar à raiz. O caminho é retornado como uma string alocada dinamicamente.
+ * até chegar à raiz. O caminho é retornado como uma string alocada dinamicamente. Não há limite de
+ * profundidade: o caminho é montado do fim para o início em um buffer que cresce conforme necessário.
  *
  * @param fs       Ponteiro para a estrutura do sistema de arquivos EXT2.
  * @param dir_ino  Número do inode do diretório cujo caminho será obtido.
@@ -812,55 +2120,162 @@ char *fs_get_path(ext2_fs_t *fs, uint32_t ino)
 {
     if (ino == EXT2_ROOT_INO)
         return strdup("/");
+    if (ino == fs->cwd_ino && fs->cwd_path) // Caminho do diretório corrente já conhecido
+        return strdup(fs->cwd_path);
 
-    char *components[64];
-    int count = 0;
-    uint32_t current_ino = ino;
+    size_t cap = 256;        // Capacidade do buffer
+    char *buf = malloc(cap); // Buffer preenchido a partir do fim
+    if (!buf)
+        return NULL;
+    size_t pos = cap - 1; // Início do caminho já montado
+    buf[pos] = '\0';
 
-    while (current_ino != EXT2_ROOT_INO && count < 64) // Limita o número de componentes a 64
+    uint32_t current_ino = ino;
+    uint32_t depth = 0;
+    char name[EXT2_NAME_LEN + 1];
+    while (current_ino != EXT2_ROOT_INO)
     {
-        struct ext2_inode inode;
-        if (fs_read_inode(fs, current_ino, &inode) < 0) // Lê o inode atual
-            return NULL;
-
         uint32_t parent_ino;
-        if (fs_find_in_dir(fs, &inode, "..", &parent_ino) < 0) // Procura o inode do pai
+        if (++depth > fs->sb.s_inodes_count) // Evita laço infinito em imagens corrompidas
+        {
+            free(buf);
             return NULL;
-
-        struct ext2_inode parent_inode;
-        if (fs_read_inode(fs, parent_ino, &parent_inode) < 0) // Lê o inode do pai
+        }
+        if (parent_name(fs, current_ino, &parent_ino, name) < 0) // Obtém o pai e o nome do inode atual
+        {
+            free(buf);
             return NULL;
+        }
 
-        struct child_ctx ctx = {.ino = current_ino};               // Inicializa o contexto de busca para o filho
-        if (fs_iterate_dir(fs, &parent_inode, child_cb, &ctx) < 0) // Itera sobre o diretório pai para encontrar o nome do filho
-            return NULL;
+        size_t len = strlen(name);
+        if (pos < len + 1) // Aumenta o buffer, mantendo o caminho montado no fim
+        {
+            size_t used = cap - pos;
+            size_t new_cap = 2 * cap + len + 1;
+            char *tmp = malloc(new_cap);
+            if (!tmp)
+            {
+                free(buf);
+                return NULL;
+            }
+            memcpy(tmp + new_cap - used, buf + pos, used);
+            free(buf);
+            buf = tmp;
+            pos = new_cap - used;
+            cap = new_cap;
+        }
 
-        components[count++] = strdup(ctx.name); // Armazena o nome do filho encontrado
-        current_ino = parent_ino;               // Atualiza o inode atual para o pai
+        pos -= len;
+        memcpy(buf + pos, name, len); // Prefixa o nome do componente
+        buf[--pos] = '/';
+        current_ino = parent_ino; // Atualiza o inode atual para o pai
     }
 
-    // Calcula o tamanho do caminho
-    size_t total_len = 1;
-    for (int i = count - 1; i >= 0; --i)
-        total_len += strlen(components[i]) + 1;
+    memmove(buf, buf + pos, cap - pos); // Move o caminho para o início do buffer
+    return buf;
+}
+
+/**
+ * @brief   Normaliza um caminho absoluto, removendo barras repetidas, "." e "..".
+ *
+ * Como não há links físicos entre diretórios, ".." sempre leva ao componente anterior.
+ *
+ * @param path  Caminho absoluto a ser normalizado (alterado no próprio buffer).
+ */
+static void path_normalize(char *path)
+{
+    char *out = path; // Posição de escrita (o resultado nunca é maior que a entrada)
+    char *in = path;
+    while (*in)
+    {
+        while (*in == '/')
+            in++;
+        char *start = in;
+        while (*in && *in != '/')
+            in++;
+        size_t len = (size_t)(in - start);
+
+        if (len == 0 || (len == 1 && start[0] == '.'))
+            continue;
+        if (len == 2 && start[0] == '.' && start[1] == '.') // Volta um componente
+        {
+            while (out > path && *--out != '/')
+                ;
+            continue;
+        }
+        *out++ = '/';
+        memmove(out, start, len);
+        out += len;
+    }
+    if (out == path) // Raiz
+        *out++ = '/';
+    *out = '\0';
+}
+
+/**
+ * @brief   Obtém o caminho do diretório corrente.
+ *
+ * O caminho é mantido em memória e atualizado por fs_set_cwd, de modo que o prompt,
+ * o pwd e fs_join_path não precisam percorrer a árvore a cada comando. Só é
+ * recalculado quando invalidado ou quando o diretório corrente muda por outro meio.
+ *
+ * @param fs   Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param cwd  Número do inode do diretório corrente.
+ *
+ * @return Caminho do diretório corrente (pertence à estrutura, não deve ser liberado), ou NULL em caso de erro.
+ */
+const char *fs_cwd_path(ext2_fs_t *fs, uint32_t cwd)
+{
+    if (fs->cwd_path && fs->cwd_ino == cwd)
+        return fs->cwd_path;
 
-    char *path = malloc(total_len + 1);
+    fs_cwd_invalidate(fs);
+    char *path = fs_get_path(fs, cwd); // Recalcula subindo pela árvore
     if (!path)
         return NULL;
+    fs->cwd_ino = cwd;
+    fs->cwd_path = path;
+    return path;
+}
 
-    char *ptr = path; // Ponteiro para construir o caminho
-    *ptr++ = '/';
-    for (int i = count - 1; i >= 0; --i)
+/**
+ * @brief   Define o diretório corrente e seu caminho absoluto.
+ *
+ * @param fs    Ponteiro para a estrutura do sistema de arquivos EXT2.
+ * @param ino   Número do inode do novo diretório corrente.
+ * @param path  Caminho absoluto usado para chegar ao diretório (pode conter "." e "..").
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro.
+ */
+int fs_set_cwd(ext2_fs_t *fs, uint32_t ino, const char *path)
+{
+    char *copy = strdup(path);
+    if (!copy)
     {
-        size_t len = strlen(components[i]);
-        memcpy(ptr, components[i], len); // Copia o componente do caminho
-        ptr += len;
-        if (i)
-            *ptr++ = '/';
-        free(components[i]);
+        fs_cwd_invalidate(fs);
+        return -1;
     }
-    *ptr = '\0'; // Garante que o caminho seja null-terminated
-    return path;
+    path_normalize(copy);
+
+    free(fs->cwd_path);
+    fs->cwd_ino = ino;
+    fs->cwd_path = copy;
+    return 0;
+}
+
+/**
+ * @brief   Descarta o caminho do diretório corrente mantido em memória.
+ *
+ * Deve ser chamada quando um diretório é renomeado ou removido, pois o
+ * caminho guardado pode deixar de ser válido.
+ *
+ * @param fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ */
+void fs_cwd_invalidate(ext2_fs_t *fs)
+{
+    free(fs->cwd_path);
+    fs->cwd_path = NULL;
+    fs->cwd_ino = 0;
 }
 
 /**
@@ -885,7 +2300,7 @@ char *fs_join_path(ext2_fs_t *fs, uint32_t cwd, const char *rel)
         return strdup(rel);
 
     // Obtém o caminho absoluto do diretório atual
-    char *base = fs_get_path(fs, cwd);
+    const char *base = fs_cwd_path(fs, cwd);
     if (!base)
         return NULL;
 
@@ -899,17 +2314,13 @@ char *fs_join_path(ext2_fs_t *fs, uint32_t cwd, const char *rel)
     size_t total_len = base_len + add_slash + rel_len + 1;
     char *full = malloc(total_len);
     if (!full)
-    {
-        free(base);
         return NULL;
-    }
 
     strcpy(full, base); // Copia o caminho base
     if (add_slash)
         strcat(full, "/");
     strcat(full, rel); // Adiciona o caminho relativo
 
-    free(base);
     return full;
 }
 
@@ -941,12 +2352,12 @@ int name_exists(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name)
         if (!block_num)
             continue;
 
-        uint8_t block_buf[EXT2_BLOCK_SIZE];
+        uint8_t block_buf[EXT2_MAX_BLOCK_SIZE];
         if (fs_read_block(fs, block_num, block_buf) < 0) // Lê o bloco do diretório
             return -1;
 
         uint32_t offset = 0;
-        while (offset < EXT2_BLOCK_SIZE)
+        while (offset < fs->block_size)
         {
             struct ext2_dir_entry *entry = (struct ext2_dir_entry *)(block_buf + offset); // Obtém a entrada de diretório
             if (entry->rec_len == 0)
@@ -964,7 +2375,7 @@ int name_exists(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name)
  * @brief   Sincroniza o superbloco do sistema de arquivos EXT2.
  *
  * Esta função escreve o superbloco atualizado de volta no disco, garantindo que as alterações
- * sejam persistidas. Utiliza a função pwrite para escrever os dados no offset do superbloco.
+ * sejam persistidas. Os dados são escritos pelo backend de E/S no offset do superbloco.
  *
  * @param fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
  *
@@ -972,8 +2383,57 @@ int name_exists(ext2_fs_t *fs, struct ext2_inode *dir_inode, char *name)
  */
 int fs_sync_super(ext2_fs_t *fs)
 {
-    ssize_t bytes_written = pwrite(fs->fd, &fs->sb, sizeof(fs->sb), EXT2_SUPER_OFFSET); // Escreve o superbloco no disco
-    if (bytes_written == (ssize_t)sizeof(fs->sb))
-        return 0;
-    return -1;
+    if (fs->io->write_range(fs, &fs->sb, sizeof(fs->sb), EXT2_SUPER_OFFSET) < 0) // Escreve o superbloco no disco
+        return -1;
+    fs->sb_dirty = 0;
+    return 0;
+}
+
+/**
+ * @brief   Grava o que o backend de E/S mantém pendente e espera o disco confirmar.
+ */
+static int fs_barrier(ext2_fs_t *fs)
+{
+    if (fs->io->flush(fs) < 0)
+        return -1;
+    return fdatasync(fs->fd);
+}
+
+/**
+ * @brief   Sincroniza todas as alterações pendentes com a imagem.
+ *
+ * Esta função copia os inodes sujos para a tabela de inodes, escreve na imagem
+ * todos os blocos sujos da cache de blocos, os descritores de grupo alterados
+ * e, em seguida, o superbloco, se algum contador mudou. Por fim, o backend de
+ * E/S grava o que estiver pendente (msync do mapeamento ou blocos alterados da
+ * imagem em memória). Fora do modo FS_DURABILITY_NONE, as escritas são
+ * confirmadas com fdatasync; no modo FS_DURABILITY_STRICT, os blocos (dados,
+ * bitmaps e tabelas de inodes) chegam ao disco antes dos descritores e do
+ * superbloco. Com o log ativo, tudo é gravado antes no log (fs_wal_write),
+ * que é zerado depois que as escritas na imagem são confirmadas.
+ *
+ * @param fs  Ponteiro para a estrutura do sistema de arquivos EXT2.
+ *
+ * @return Retorna 0 em caso de sucesso, ou -1 em caso de erro na escrita.
+ */
+int fs_sync(ext2_fs_t *fs)
+{
+    int ret = fs_icache_flush(fs);                                    // Copia os inodes sujos para a tabela de inodes
+    int logged = fs->wal_fd >= 0 ? fs_wal_write(fs) : 0;              // Grava antes no log o que vai ser escrito na imagem
+    if (logged < 0)
+        return -1;
+    if (fs_bcache_flush(fs) < 0)                                      // Escreve os blocos sujos
+        ret = -1;
+    if (fs->durability == FS_DURABILITY_STRICT && fs_barrier(fs) < 0) // Blocos no disco antes dos contadores
+        ret = -1;
+    if (fs_flush_group_descs(fs) < 0)                                 // Escreve os descritores de grupo alterados
+        ret = -1;
+    if (fs->sb_dirty && fs_sync_super(fs) < 0)                        // Escreve o superbloco, se alterado
+        ret = -1;
+    int durable = fs->durability != FS_DURABILITY_NONE || logged;
+    if ((durable ? fs_barrier(fs) : fs->io->flush(fs)) < 0)           // Grava o que o backend mantém pendente (e espera o disco, se durável)
+        ret = -1;
+    if (logged && !ret && fs_wal_clear(fs) < 0)                       // Lote na imagem: o log pode ser zerado
+        ret = -1;
+    return ret;
 }
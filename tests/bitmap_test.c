@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    bitmap_test.c
+ *
+ * Teste das buscas em bitmaps (bitmap_find_clear, bitmap_find_clear_n e
+ * bitmap_find_clear_run), comparadas com uma busca bit a bit.
+ *
+ * Os casos fixos cobrem sequências livres que atravessam palavras de 64 bits
+ * e trechos de 128 bits (pulados de uma vez com SSE2), um bitmap cuja última
+ * palavra é curta (com bits livres no buffer além do fim) e pedidos maiores
+ * que o espaço livre. Em seguida, bitmaps pseudoaleatórios são comparados
+ * com a busca bit a bit em todas as posições de início.
+ *
+ * Uso: bitmap_test [imagem] (a imagem passada por make test não é usada)
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define MAP_BYTES 64 // Bitmaps de até 512 bits (oito palavras de 64 bits)
+#define RANDOM_MAPS 200
+
+/**
+ * @brief   Verifica se o bit 'i' está livre, tratando bits além de 'nbits' como ocupados.
+ */
+static int is_clear(const uint8_t *map, uint32_t nbits, uint32_t i)
+{
+    return i < nbits && !(map[BIT_BYTE(i)] & BIT_MASK(i));
+}
+
+/**
+ * @brief   bitmap_find_clear_run bit a bit.
+ */
+static int naive_run(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out)
+{
+    for (uint32_t i = start; n && i < nbits; ++i)
+    {
+        uint32_t len = 0;
+        while (len < n && is_clear(map, nbits, i + len))
+            len++;
+        if (len == n)
+        {
+            *out = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief   bitmap_find_clear_n bit a bit.
+ */
+static uint32_t naive_n(const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n, uint32_t *out)
+{
+    uint32_t found = 0;
+    for (uint32_t i = start; i < nbits && found < n; ++i)
+        if (is_clear(map, nbits, i))
+            out[found++] = i;
+    return found;
+}
+
+/**
+ * @brief   Compara as três buscas com as versões bit a bit para um bitmap, uma posição e um tamanho.
+ *
+ * @return  1 se os resultados coincidem, 0 caso contrário (com a diferença impressa).
+ */
+static int check(const char *name, const uint8_t *map, uint32_t nbits, uint32_t start, uint32_t n)
+{
+    uint32_t got = 0, want = 0;
+    int r = bitmap_find_clear_run(map, nbits, start, n, &got);
+    int e = naive_run(map, nbits, start, n, &want);
+    if (r != e || (r == 0 && got != want))
+    {
+        fprintf(stderr, "FAIL: %s: find_clear_run(nbits=%u, start=%u, n=%u) = %d/%u, esperado %d/%u\n", name, nbits, start, n, r, got, e, want);
+        return 0;
+    }
+
+    r = bitmap_find_clear(map, nbits, start, &got);
+    e = naive_run(map, nbits, start, 1, &want);
+    if (r != e || (r == 0 && got != want))
+    {
+        fprintf(stderr, "FAIL: %s: find_clear(nbits=%u, start=%u) = %d/%u, esperado %d/%u\n", name, nbits, start, r, got, e, want);
+        return 0;
+    }
+
+    uint32_t got_n[MAP_BYTES * 8], want_n[MAP_BYTES * 8];
+    uint32_t k = bitmap_find_clear_n(map, nbits, start, n, got_n);
+    uint32_t m = naive_n(map, nbits, start, n, want_n);
+    if (k != m || memcmp(got_n, want_n, k * sizeof(*got_n)))
+    {
+        fprintf(stderr, "FAIL: %s: find_clear_n(nbits=%u, start=%u, n=%u) achou %u bits, esperado %u\n", name, nbits, start, n, k, m);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief   Monta um bitmap todo ocupado com os bits livres de 'from' a 'to' (exclusivo).
+ */
+static void map_with_hole(uint8_t *map, uint32_t from, uint32_t to)
+{
+    memset(map, 0xff, MAP_BYTES);
+    bitmap_clear_run(map, from, to - from);
+}
+
+int main(void)
+{
+    uint8_t map[MAP_BYTES];
+    int ok = 1;
+
+    // Sequência livre atravessando a fronteira de 64 bits
+    map_with_hole(map, 60, 70);
+    ok &= check("fronteira 64", map, 512, 0, 10);
+    ok &= check("fronteira 64, pedido maior", map, 512, 0, 11);
+    ok &= check("fronteira 64, início no meio", map, 512, 63, 7);
+
+    // Sequência livre atravessando a fronteira de 128 bits, depois de trechos inteiros ocupados
+    map_with_hole(map, 250, 390);
+    ok &= check("fronteira 128", map, 512, 0, 140);
+    ok &= check("fronteira 128, pedido maior", map, 512, 0, 141);
+    ok &= check("fronteira 128, início na sequência", map, 512, 256, 134);
+
+    // Última palavra curta: bits livres no buffer depois de 'nbits' não contam
+    map_with_hole(map, 90, 128);
+    ok &= check("última palavra curta", map, 100, 0, 10);
+    ok &= check("última palavra curta, pedido maior", map, 100, 0, 11);
+    ok &= check("última palavra curta, início no fim", map, 100, 99, 1);
+    ok &= check("início depois do fim", map, 100, 100, 1);
+
+    // Pedido maior que o espaço livre e bitmap todo livre
+    memset(map, 0, sizeof(map));
+    bitmap_set_run(map, 0, 100);
+    ok &= check("pedido maior que o espaço livre", map, 300, 0, 201);
+    ok &= check("sequência até o fim", map, 300, 0, 200);
+    memset(map, 0, sizeof(map));
+    ok &= check("bitmap livre", map, 512, 0, 512);
+    ok &= check("bitmap livre, pedido maior", map, 512, 1, 512);
+
+    // Bitmaps pseudoaleatórios com trechos longos ocupados e livres
+    srand(16102026);
+    for (int t = 0; t < RANDOM_MAPS && ok; ++t)
+    {
+        uint32_t nbits = 1 + (uint32_t)rand() % (MAP_BYTES * 8);
+        uint32_t pos = 0;
+        int used = rand() & 1;
+        memset(map, 0, sizeof(map));
+        while (pos < MAP_BYTES * 8) // Alterna sequências ocupadas e livres de 1 a 150 bits
+        {
+            uint32_t len = 1 + (uint32_t)rand() % 150;
+            if (len > MAP_BYTES * 8 - pos)
+                len = MAP_BYTES * 8 - pos;
+            if (used)
+                bitmap_set_run(map, pos, len);
+            pos += len;
+            used = !used;
+        }
+        for (uint32_t start = 0; start <= nbits && ok; ++start)
+        {
+            uint32_t sizes[] = {1, 2, 63, 64, 65, 127, 128, 129, 1 + (uint32_t)rand() % nbits};
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && ok; ++s)
+                ok &= check("aleatório", map, nbits, start, sizes[s]);
+        }
+    }
+
+    puts(ok ? "bitmap_test: OK" : "bitmap_test: FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
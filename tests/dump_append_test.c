@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    dump_append_test.c
+ *
+ * Teste da exportação de arquivos (fs_dump_file) pelo caminho do kernel.
+ *
+ * Um arquivo com uma sequência contígua maior que FS_COPY_MIN_BYTES é montado
+ * direto na imagem e exportado para um arquivo regular, primeiro truncado
+ * ("wb") e depois em modo de acréscimo ("ab", O_APPEND), onde copy_file_range
+ * e sendfile não são aceitos. Nos dois casos o conteúdo deve sair inteiro.
+ *
+ * Uso: dump_append_test <imagem.ext2> (uma imagem recém-criada, com blocos de 1 KiB)
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define PREFIX "conteúdo anterior\n" // Já está no destino antes do acréscimo
+
+/**
+ * @brief   Byte esperado na posição 'pos' do arquivo de teste.
+ */
+static uint8_t pattern(uint64_t pos)
+{
+    return (uint8_t)(pos * 7 + pos / 1024);
+}
+
+/**
+ * @brief   Cria na imagem um arquivo regular de 'nblocks' blocos contíguos (um bloco indireto simples).
+ *
+ * @return  Número do inode ou 0 em caso de erro.
+ */
+static uint32_t make_file(ext2_fs_t *fs, uint32_t nblocks)
+{
+    uint32_t bs = fs->block_size;
+    uint32_t ino, ind, data, len;
+    if (nblocks <= 12 || nblocks > 12 + fs->ptrs_per_block)
+        return 0;
+    if (fs_alloc_inode(fs, EXT2_S_IFREG | 0644, EXT2_ROOT_INO, &ino) < 0 || fs_alloc_block(fs, 0, &ind) < 0)
+        return 0;
+    if (fs_alloc_blocks(fs, ind + 1, nblocks, &data, &len) < 0 || len != nblocks)
+        return 0;
+
+    uint8_t *buf = malloc(bs);
+    uint32_t *tbl = calloc(1, bs);
+    int ok = buf && tbl;
+    for (uint32_t i = 0; ok && i < nblocks; ++i)
+    {
+        for (uint32_t k = 0; k < bs; ++k)
+            buf[k] = pattern((uint64_t)i * bs + k);
+        ok = fs_write_block(fs, data + i, buf) == 0;
+        if (i >= 12)
+            tbl[i - 12] = data + i;
+    }
+    ok = ok && fs_write_block(fs, ind, tbl) == 0;
+
+    struct ext2_inode inode;
+    memset(&inode, 0, sizeof(inode));
+    inode.i_mode = EXT2_S_IFREG | 0644;
+    inode.i_links_count = 1;
+    inode.i_size = nblocks * bs;
+    inode.i_blocks = (nblocks + 1) * (bs / 512);
+    for (uint32_t i = 0; i < 12; ++i)
+        inode.i_block[i] = data + i;
+    inode.i_block[12] = ind;
+    ok = ok && fs_write_inode(fs, ino, &inode) == 0 && fs_sync(fs) == 0; // Blocos sujos não vão pelo kernel
+
+    free(buf);
+    free(tbl);
+    return ok ? ino : 0;
+}
+
+/**
+ * @brief   Exporta o arquivo para 'path' aberto com 'mode' e confere o resultado.
+ *
+ * @return  1 se o destino tem 'skip' bytes anteriores seguidos do arquivo inteiro, 0 caso contrário.
+ */
+static int dump_check(ext2_fs_t *fs, uint32_t ino, uint64_t size, const char *path, const char *mode, size_t skip)
+{
+    FILE *out = fopen(path, mode);
+    if (!out)
+        return 0;
+    int ret = fs_dump_file(fs, ino, out);
+    if (fclose(out) != 0 || ret < 0)
+    {
+        fprintf(stderr, "FAIL: fs_dump_file (%s)\n", mode);
+        return 0;
+    }
+
+    FILE *in = fopen(path, "rb");
+    if (!in)
+        return 0;
+    uint64_t pos = 0;
+    int c, ok = 1;
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (pos >= skip && pos - skip < size && (uint8_t)c != pattern(pos - skip))
+            ok = 0;
+        pos++;
+    }
+    fclose(in);
+    if (!ok || pos != skip + size)
+    {
+        fprintf(stderr, "FAIL: destino com %llu bytes (esperados %llu, modo %s)\n", (unsigned long long)pos, (unsigned long long)(skip + size), mode);
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Uso: %s <imagem.ext2>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ext2_fs_t *fs = fs_open(argv[1], 0);
+    if (!fs)
+    {
+        fprintf(stderr, "FAIL: não foi possível abrir %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t nblocks = (FS_COPY_MIN_BYTES / fs->block_size) + 8; // Uma única sequência longa
+    uint64_t size = (uint64_t)nblocks * fs->block_size;
+    uint32_t ino = make_file(fs, nblocks);
+    if (!ino)
+    {
+        fprintf(stderr, "FAIL: não foi possível criar o arquivo de teste\n");
+        fs_close(fs);
+        return EXIT_FAILURE;
+    }
+
+    char path[4096]; // Destino ao lado da imagem (mesmo sistema de arquivos)
+    snprintf(path, sizeof(path), "%s.out", argv[1]);
+    int ok = dump_check(fs, ino, size, path, "wb", 0);
+
+    FILE *out = fopen(path, "wb");
+    ok = ok && out && fputs(PREFIX, out) >= 0;
+    if (out)
+        fclose(out);
+    ok = ok && dump_check(fs, ino, size, path, "ab", strlen(PREFIX));
+
+    remove(path);
+    fs_close(fs);
+    puts(ok ? "dump_append_test: OK" : "dump_append_test: FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+/**
+ * @file    free_blocks_test.c
+ *
+ * Teste da liberação de blocos em vários grupos (fs_free_blocks).
+ *
+ * Uma sequência que começa em blocos ocupados no fim de um grupo e termina
+ * em um bloco já livre do grupo seguinte deve falhar sem alterar nada: nem
+ * o bitmap e o descritor do primeiro grupo, nem o superbloco. Em seguida,
+ * a liberação só dos blocos ocupados deve funcionar.
+ *
+ * Uso: free_blocks_test <imagem.ext2> (uma imagem recém-criada com pelo menos três grupos)
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define TAIL_BLOCKS 5 // Blocos ocupados no fim do grupo 1
+
+/**
+ * @brief   Conta quantos blocos de uma sequência dentro de um grupo estão marcados como usados.
+ */
+static uint32_t used_blocks(ext2_fs_t *fs, uint32_t group, uint32_t block, uint32_t count)
+{
+    struct ext2_group_desc gd;
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    if (fs_read_group_desc(fs, group, &gd) < 0 || fs_read_block(fs, gd.bg_block_bitmap, bitmap) < 0)
+        return 0;
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t idx = block + i - fs->sb.s_first_data_block - group * fs->sb.s_blocks_per_group;
+        used += (bitmap[BIT_BYTE(idx)] & BIT_MASK(idx)) != 0;
+    }
+    return used;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Uso: %s <imagem.ext2>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ext2_fs_t *fs = fs_open(argv[1], 0);
+    if (!fs || fs->groups_count < 3)
+    {
+        fprintf(stderr, "FAIL: não foi possível abrir %s com pelo menos três grupos\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t group2 = fs->sb.s_first_data_block + 2 * fs->sb.s_blocks_per_group; // Primeiro bloco do grupo 2
+    uint32_t tail = group2 - TAIL_BLOCKS;
+    uint32_t got, len;
+    if (fs_alloc_blocks(fs, tail, TAIL_BLOCKS, &got, &len) < 0 || got != tail || len != TAIL_BLOCKS)
+    {
+        fprintf(stderr, "FAIL: não foi possível ocupar o fim do grupo 1\n");
+        return EXIT_FAILURE;
+    }
+
+    struct ext2_group_desc gd2;
+    uint8_t bitmap[EXT2_MAX_BLOCK_SIZE];
+    uint32_t idx;
+    if (fs_read_group_desc(fs, 2, &gd2) < 0 || fs_read_block(fs, gd2.bg_block_bitmap, bitmap) < 0 || bitmap_find_clear(bitmap, fs->sb.s_blocks_per_group, 0, &idx) < 0)
+    {
+        fprintf(stderr, "FAIL: grupo 2 sem blocos livres\n");
+        return EXIT_FAILURE;
+    }
+
+    struct ext2_group_desc gd1, after;
+    fs_read_group_desc(fs, 1, &gd1);
+    uint32_t sb_free = fs->sb.s_free_blocks_count;
+
+    int ok = 1;
+    if (fs_free_blocks(fs, tail, TAIL_BLOCKS + idx + 1) == 0) // Vai até o primeiro bloco livre do grupo 2
+    {
+        fprintf(stderr, "FAIL: liberar um bloco já livre não falhou\n");
+        ok = 0;
+    }
+    fs_read_group_desc(fs, 1, &after);
+    if (ok && (used_blocks(fs, 1, tail, TAIL_BLOCKS) != TAIL_BLOCKS || after.bg_free_blocks_count != gd1.bg_free_blocks_count || fs->sb.s_free_blocks_count != sb_free))
+    {
+        fprintf(stderr, "FAIL: a liberação que falhou alterou o grupo 1 ou o superbloco\n");
+        ok = 0;
+    }
+
+    if (ok && fs_free_blocks(fs, tail, TAIL_BLOCKS) < 0)
+    {
+        fprintf(stderr, "FAIL: fs_free_blocks dos blocos ocupados\n");
+        ok = 0;
+    }
+    fs_read_group_desc(fs, 1, &after);
+    if (ok && (used_blocks(fs, 1, tail, TAIL_BLOCKS) != 0 || after.bg_free_blocks_count != gd1.bg_free_blocks_count + TAIL_BLOCKS || fs->sb.s_free_blocks_count != sb_free + TAIL_BLOCKS))
+    {
+        fprintf(stderr, "FAIL: contadores errados depois da liberação\n");
+        ok = 0;
+    }
+
+    fs_close(fs);
+    puts(ok ? "free_blocks_test: OK" : "free_blocks_test: FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
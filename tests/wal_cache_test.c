@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "utils.h"
+
+/**
+ * @file    wal_cache_test.c
+ *
+ * Teste da cache de blocos dentro de uma transação com log (FS_OPEN_WAL).
+ *
+ * 1. Uma única transação escreve mais blocos do que cabem na cache. Antes do
+ *    fs_txn_commit nenhum desses blocos pode ter chegado à imagem (nem o log,
+ *    que só é gravado na confirmação); depois dela, todos devem estar na imagem.
+ * 2. Uma transação suja alguns inodes e enche a cache de blocos sujos. Na
+ *    confirmação, a gravação dos inodes lê tabelas de inodes pela cache; com a
+ *    gravação do log forçada a falhar, a imagem deve continuar intacta.
+ *
+ * Uso: wal_cache_test <imagem.ext2> (uma imagem recém-criada, com blocos de 1 KiB)
+ *
+ * @authors Artur Bento de Carvalho
+ *          Eduardo Riki Matushita
+ *          Rafaela Tieri Iwamoto Ferreira
+ *          Tiago Defendi da Silva
+ *
+ * @date    16/10/2026
+ */
+
+#define EXTRA_BLOCKS 64 // Blocos escritos além da capacidade inicial da cache
+
+/**
+ * @brief   Conta quantos blocos da sequência já têm na imagem o conteúdo escrito pelo teste.
+ */
+static uint32_t blocks_on_disk(int fd, uint32_t block_size, uint32_t first, uint32_t count, uint8_t fill)
+{
+    uint8_t *buf = malloc(block_size);
+    uint32_t found = 0;
+    for (uint32_t i = 0; buf && i < count; ++i)
+        if (pread(fd, buf, block_size, (off_t)(first + i) * block_size) == (ssize_t)block_size && buf[0] == (uint8_t)(first + i) && buf[block_size - 1] == fill)
+            found++;
+    free(buf);
+    return found;
+}
+
+/**
+ * @brief   Escreve 'count' blocos a partir de 'first' com o conteúdo reconhecido por blocks_on_disk.
+ */
+static int write_blocks(ext2_fs_t *fs, uint8_t *buf, uint32_t first, uint32_t count, uint8_t fill)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        memset(buf, fill, fs->block_size);
+        buf[0] = (uint8_t)(first + i);
+        if (fs_write_block(fs, first + i, buf) < 0)
+        {
+            fprintf(stderr, "FAIL: fs_write_block do bloco %u\n", first + i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   Lê a imagem inteira para a memória.
+ */
+static uint8_t *image_read(int fd, off_t *size)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+        return NULL;
+    uint8_t *img = malloc((size_t)st.st_size);
+    if (img && pread(fd, img, (size_t)st.st_size, 0) != st.st_size)
+    {
+        free(img);
+        return NULL;
+    }
+    *size = st.st_size;
+    return img;
+}
+
+/**
+ * @brief   Caso 1: a cache cresce em vez de gravar blocos da transação antes do log.
+ */
+static int cache_grow_test(char *path, int fd)
+{
+    ext2_fs_t *fs = fs_open(path, FS_OPEN_WAL);
+    if (!fs)
+    {
+        fprintf(stderr, "FAIL: não foi possível abrir %s\n", path);
+        return 0;
+    }
+
+    uint32_t capacity = fs->bcache.capacity;
+    uint32_t count = capacity + EXTRA_BLOCKS;
+    uint32_t first = fs->sb.s_blocks_count - count - 1; // Blocos livres no fim de uma imagem recém-criada
+    uint8_t *buf = malloc(fs->block_size);
+    if (!buf || fs->sb.s_blocks_count <= 2 * count + fs->sb.s_first_data_block + 256)
+    {
+        fprintf(stderr, "FAIL: imagem pequena demais\n");
+        free(buf);
+        fs_close(fs);
+        return 0;
+    }
+
+    fs_txn_begin(fs);
+    int ok = write_blocks(fs, buf, first, count, 0xa5) == 0;
+
+    uint32_t early = blocks_on_disk(fd, fs->block_size, first, count, 0xa5);
+    if (ok && early) // Nada da transação pode chegar à imagem antes do log
+    {
+        fprintf(stderr, "FAIL: %u blocos escritos na imagem antes do log\n", early);
+        ok = 0;
+    }
+    if (ok && fs->bcache.capacity <= capacity)
+    {
+        fprintf(stderr, "FAIL: a cache não cresceu (%u blocos)\n", fs->bcache.capacity);
+        ok = 0;
+    }
+
+    if (fs_txn_commit(fs) < 0)
+    {
+        fprintf(stderr, "FAIL: fs_txn_commit\n");
+        ok = 0;
+    }
+    uint32_t late = blocks_on_disk(fd, fs->block_size, first, count, 0xa5);
+    if (ok && late != count)
+    {
+        fprintf(stderr, "FAIL: %u de %u blocos na imagem depois do commit\n", late, count);
+        ok = 0;
+    }
+
+    free(buf);
+    fs_close(fs);
+    return ok;
+}
+
+/**
+ * @brief   Caso 2: a confirmação não grava blocos da transação na imagem antes do log.
+ */
+static int commit_test(char *path, int fd)
+{
+    ext2_fs_t *fs = fs_open(path, FS_OPEN_WAL);
+    if (!fs)
+    {
+        fprintf(stderr, "FAIL: não foi possível abrir %s\n", path);
+        return 0;
+    }
+
+    uint32_t count = fs->bcache.capacity;
+    uint32_t first = fs->sb.s_blocks_count - 2 * count - EXTRA_BLOCKS - 1; // Antes dos blocos do caso 1
+    uint8_t *buf = malloc(fs->block_size);
+    off_t size = 0;
+    uint8_t *before = image_read(fd, &size);
+    if (!buf || !before)
+    {
+        fprintf(stderr, "FAIL: memória insuficiente\n");
+        free(buf);
+        free(before);
+        fs_close(fs);
+        return 0;
+    }
+
+    int ok = 1;
+    fs_txn_begin(fs);
+    uint32_t inos[] = {EXT2_ROOT_INO, 11}; // Raiz e lost+found
+    for (size_t i = 0; i < sizeof(inos) / sizeof(inos[0]); ++i)
+    {
+        struct ext2_inode *inode = fs_iget(fs, inos[i]);
+        if (!inode)
+        {
+            fprintf(stderr, "FAIL: fs_iget do inode %u\n", inos[i]);
+            ok = 0;
+            break;
+        }
+        inode->i_mtime ^= 0x5a5a5a5a;
+        fs_idirty(fs, inode);
+        fs_iput(fs, inode);
+    }
+    if (ok) // Enche a cache de blocos sujos: as tabelas de inodes saem da cache
+        ok = write_blocks(fs, buf, first, count, 0x5a) == 0;
+    if (ok && (fs->bcache.dirty != fs->bcache.used || fs->bcache.used != fs->bcache.capacity))
+    {
+        fprintf(stderr, "FAIL: cache não está cheia de blocos sujos (%u/%u/%u)\n", fs->bcache.dirty, fs->bcache.used, fs->bcache.capacity);
+        ok = 0;
+    }
+
+    int wal_fd = fs->wal_fd; // A gravação do log falha: a confirmação para antes de tocar a imagem
+    fs->wal_fd = open("/dev/null", O_RDONLY);
+    if (ok && fs_txn_commit(fs) == 0)
+    {
+        fprintf(stderr, "FAIL: fs_txn_commit não falhou sem o log\n");
+        ok = 0;
+    }
+    close(fs->wal_fd);
+    fs->wal_fd = wal_fd;
+
+    off_t size_after = 0;
+    uint8_t *after = image_read(fd, &size_after);
+    if (ok && (!after || size_after != size || memcmp(before, after, (size_t)size)))
+    {
+        fprintf(stderr, "FAIL: a imagem mudou antes do log\n");
+        ok = 0;
+    }
+
+    if (ok && fs_sync(fs) < 0) // Agora com o log: tudo chega à imagem
+    {
+        fprintf(stderr, "FAIL: fs_sync\n");
+        ok = 0;
+    }
+    uint32_t late = blocks_on_disk(fd, fs->block_size, first, count, 0x5a);
+    if (ok && late != count)
+    {
+        fprintf(stderr, "FAIL: %u de %u blocos na imagem depois do fs_sync\n", late, count);
+        ok = 0;
+    }
+
+    free(buf);
+    free(before);
+    free(after);
+    fs_close(fs);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Uso: %s <imagem.ext2>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "FAIL: não foi possível abrir %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    int ok = cache_grow_test(argv[1], fd);
+    ok = ok && commit_test(argv[1], fd);
+
+    close(fd);
+    puts(ok ? "wal_cache_test: OK" : "wal_cache_test: FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}